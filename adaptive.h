@@ -0,0 +1,108 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+#include "pool.h"
+namespace Chartify{
+    // Resolution-aware sampling of y = f(x) for a plot of width x height pixels. Starts from a
+    // uniform grid every initial_step pixels and bisects each interval whose midpoint lands more
+    // than tolerance pixels off the chord between its ends, until neighbouring samples are at
+    // most resolution pixels apart, so straight stretches stay sparse and fast oscillations are
+    // followed down to the display resolution. Every level's midpoints are evaluated as one
+    // batch on the pool: f must be safe to call from several threads at once. Distances are
+    // measured against the y range of the samples so far, the range the canvas fits the series
+    // to. Non-finite values are refined around and then dropped.
+    class Sampler{
+        struct Node{
+            double x, y;
+        };
+        struct Span{
+            std::size_t a, b;
+        };
+        static constexpr float initial_step = 8;
+        static constexpr float resolution = 0.5f;
+        ThreadPool* pool_;
+        std::vector<Node> nodes_;
+        std::vector<Span> spans_, next_;
+        std::vector<double> x_, y_;
+        std::size_t evaluations_ = 0;
+        template<class F>
+        void Evaluate(F& f, std::size_t from){
+            Node* node = nodes_.data() + from;
+            const std::size_t n = nodes_.size() - from;
+            evaluations_ += n;
+            pool_->For(n, [&](std::size_t i, std::size_t){node[i].y = static_cast<double>(f(node[i].x));});
+        }
+    public:
+        explicit Sampler(ThreadPool& pool = ThreadPool::Shared()) : pool_(&pool){}
+        template<class F>
+        void Run(F&& f, double x0, double x1, float width, float height, float tolerance = 0.5f){
+            if(!(x0 < x1) || !std::isfinite(x0) || !std::isfinite(x1)){
+                throw std::invalid_argument("Invalid function range!");
+            }
+            if(!(width > 0) || !(height > 0) || !(tolerance > 0)){
+                throw std::invalid_argument("Invalid sampling resolution!");
+            }
+            nodes_.clear(), spans_.clear();
+            evaluations_ = 0;
+            const std::size_t first = std::max<std::size_t>(2, static_cast<std::size_t>(std::ceil(width / initial_step)));
+            for(std::size_t k = 0; k <= first; ++k){
+                nodes_.push_back(Node{k == first ? x1 : x0 + (x1 - x0) * k / first, 0});
+                if(k > 0){
+                    spans_.push_back(Span{k - 1, k});
+                }
+            }
+            Evaluate(f, 0);
+            double y0 = HUGE_VAL, y1 = -HUGE_VAL;
+            auto extend = [&](std::size_t from){
+                for(std::size_t i = from; i < nodes_.size(); ++i){
+                    if(std::isfinite(nodes_[i].y)){
+                        y0 = std::min(y0, nodes_[i].y), y1 = std::max(y1, nodes_[i].y);
+                    }
+                }
+            };
+            extend(0);
+            const double sx = width / (x1 - x0);
+            while(!spans_.empty()){
+                const std::size_t from = nodes_.size();
+                for(const Span& s : spans_){
+                    nodes_.push_back(Node{(nodes_[s.a].x + nodes_[s.b].x) / 2, 0});
+                }
+                Evaluate(f, from);
+                extend(from);
+                const double sy = y1 > y0 ? height / (y1 - y0) : 0;
+                next_.clear();
+                for(std::size_t k = 0; k < spans_.size(); ++k){
+                    const Node &a = nodes_[spans_[k].a], &b = nodes_[spans_[k].b], &m = nodes_[from + k];
+                    if((m.x - a.x) * sx <= resolution){
+                        continue;
+                    }
+                    const int finite = std::isfinite(a.y) + std::isfinite(m.y) + std::isfinite(b.y);
+                    bool split = finite > 0 && finite < 3;
+                    if(finite == 3){
+                        const double chord = a.y + (b.y - a.y) * (m.x - a.x) / (b.x - a.x);
+                        split = std::abs(m.y - chord) * sy > tolerance;
+                    }
+                    if(split){
+                        next_.push_back(Span{spans_[k].a, from + k});
+                        next_.push_back(Span{from + k, spans_[k].b});
+                    }
+                }
+                spans_.swap(next_);
+            }
+            std::sort(nodes_.begin(), nodes_.end(), [](const Node& p, const Node& q){return p.x < q.x;});
+            x_.clear(), y_.clear();
+            for(const Node& node : nodes_){
+                if(std::isfinite(node.y)){
+                    x_.push_back(node.x), y_.push_back(node.y);
+                }
+            }
+        }
+        const std::vector<double>& X() const {return x_;}
+        const std::vector<double>& Y() const {return y_;}
+        // Calls of f made by the last Run.
+        std::size_t Evaluations() const {return evaluations_;}
+    };
+};
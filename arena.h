@@ -0,0 +1,73 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+namespace Chartify{
+    // Bump allocator for transient per-frame data. Allocate() hands out storage until Reset()
+    // releases all of it at once at the end of the frame. When a frame needed more than one
+    // chunk, Reset() merges them into a single chunk of the combined size, so once the largest
+    // frame has been seen, later frames never touch the heap and memory stays at that peak.
+    class Arena{
+        struct Chunk{
+            std::unique_ptr<unsigned char[]> data;
+            std::size_t size;
+        };
+        std::vector<Chunk> chunks_;
+        std::size_t used_ = 0, bytes_ = 0, peak_ = 0;
+        void Grow(std::size_t bytes){
+            std::size_t size = std::max(bytes, chunks_.empty() ? std::size_t(1) << 16 : chunks_.back().size * 2);
+            chunks_.push_back(Chunk{std::unique_ptr<unsigned char[]>(new unsigned char[size]), size});
+            used_ = 0;
+        }
+    public:
+        explicit Arena(std::size_t reserve = 0){
+            if(reserve > 0){
+                Grow(reserve);
+            }
+        }
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+        // Default-constructed storage for n objects, valid until the next Reset().
+        template<class T>
+        T* Allocate(std::size_t n){
+            static_assert(std::is_trivially_destructible<T>::value, "Arena objects are never destroyed!");
+            static_assert(alignof(T) <= alignof(std::max_align_t), "Over-aligned types are not supported!");
+            const std::size_t bytes = n * sizeof(T);
+            std::size_t at = (used_ + alignof(T) - 1) & ~(alignof(T) - 1);
+            if(chunks_.empty() || at + bytes > chunks_.back().size){
+                Grow(bytes);
+                at = 0;
+            }
+            T* p = reinterpret_cast<T*>(chunks_.back().data.get() + at);
+            std::uninitialized_default_construct_n(p, n);
+            used_ = at + bytes;
+            bytes_ += bytes;
+            peak_ = std::max(peak_, bytes_);
+            return p;
+        }
+        void Reset(){
+            if(chunks_.size() > 1){
+                std::size_t size = 0;
+                for(const Chunk& chunk : chunks_){
+                    size += chunk.size;
+                }
+                chunks_.clear();
+                Grow(size);
+            }
+            used_ = bytes_ = 0;
+        }
+        // Bytes handed out since the last Reset(), the most ever handed out in one frame, and
+        // the memory held.
+        std::size_t Used() const {return bytes_;}
+        std::size_t Peak() const {return peak_;}
+        std::size_t Capacity() const {
+            std::size_t size = 0;
+            for(const Chunk& chunk : chunks_){
+                size += chunk.size;
+            }
+            return size;
+        }
+    };
+};
@@ -0,0 +1,30 @@
+#include "batch.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+using namespace matplotlib;
+int main(int argc, char** argv){
+    if(argc < 2){
+        std::fprintf(stderr, "usage: %s <manifest> [threads]\n", argv[0]);
+        return 2;
+    }
+    Batch batch = Batch::Parse(argv[1]);
+    std::size_t threads = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : std::thread::hardware_concurrency();
+    Chartify::ThreadPool pool(threads == 0 ? 1 : threads);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Report> reports = batch.Run(pool);
+    double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::size_t points = 0, failed = 0;
+    for(const Report& r : reports){
+        if(!r.error.empty()){
+            std::printf("%s: FAILED: %s\n", r.output.c_str(), r.error.c_str());
+            ++failed;
+            continue;
+        }
+        points += r.points;
+        double ms = r.load_ms + r.render_ms;
+        std::printf("%s: %zu points, load %.2f ms, render %.2f ms, %.1f Mpoints/s, worker %zu\n", r.output.c_str(), r.points, r.load_ms, r.render_ms, r.points / ms / 1e3, r.worker);
+    }
+    std::printf("%zu jobs on %zu threads in %.3f s: %.1f jobs/s, %.1f Mpoints/s\n", reports.size(), pool.Size(), total, reports.size() / total, points / total / 1e6);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,174 @@
+#pragma once
+#include "matplotlib.h"
+#include "pool.h"
+#include "loader.h"
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+namespace matplotlib{
+    struct Job{
+        std::string output;
+        std::vector<std::string> data;
+        std::vector<Color> color;
+        std::vector<unsigned int> linestyle;
+        sf::String title;
+        unsigned int width = Screen::Width, height = Screen::Height;
+    };
+    struct Report{
+        std::string output;
+        std::size_t points = 0, worker = 0;
+        double load_ms = 0, render_ms = 0;
+        std::string error;
+    };
+    // Renders many independent charts on a thread pool. Every worker keeps one headless Canvas
+    // as scratch, so projection, decimation and stroke buffers are reused from job to job.
+    // Series are always decimated: output files are bounded by the image size anyway.
+    class Batch{
+        std::vector<Job> jobs_;
+        // A data spec is either a delimited text file (first two columns) or two raw float64
+        // column files joined with '+', which are mapped instead of read.
+        static std::pair<Chartify::Column, Chartify::Column> Load(const std::string& spec){
+            std::size_t plus = spec.find('+');
+            if(plus == std::string::npos){
+                return Chartify::Loader::Csv(spec);
+            }
+            Chartify::Column x = Chartify::Loader::Map(spec.substr(0, plus), Chartify::Precision::Double);
+            Chartify::Column y = Chartify::Loader::Map(spec.substr(plus + 1), Chartify::Precision::Double);
+            if(x.Size() != y.Size()){
+                throw std::invalid_argument("Column files have different lengths: " + spec);
+            }
+            return std::make_pair(std::move(x), std::move(y));
+        }
+        static Color ParseColor(const std::string& name){
+            if(name == "blue"){return Color::Blue();}
+            if(name == "red"){return Color::Red();}
+            if(name == "green"){return Color::Green();}
+            if(name == "orange"){return Color::Orange();}
+            if(name == "violet"){return Color::Violet();}
+            if(name == "black"){return Color::Black();}
+            std::vector<uint8_t> rgb;
+            std::stringstream stream(name);
+            std::string item;
+            while(std::getline(stream, item, ',')){
+                int value = -1;
+                try{
+                    value = std::stoi(item);
+                }
+                catch(const std::logic_error&){}
+                if(value < 0 || value > 255){
+                    throw std::invalid_argument("Unknown color: " + name);
+                }
+                rgb.push_back(static_cast<uint8_t>(value));
+            }
+            if(rgb.size() != 3){
+                throw std::invalid_argument("Unknown color: " + name);
+            }
+            return Color(rgb, 255);
+        }
+        // A line style, a marker, or both joined with '+', e.g. "solid+circle".
+        static unsigned int ParseStyle(const std::string& name){
+            std::size_t plus = name.find('+');
+            if(plus != std::string::npos){
+                return ParseStyle(name.substr(0, plus)) | ParseStyle(name.substr(plus + 1));
+            }
+            if(name == "solid"){return Flag::Solid;}
+            if(name == "dashed"){return Flag::Dashed;}
+            if(name == "dotted"){return Flag::Dotted;}
+            if(name == "point"){return Flag::Point;}
+            if(name == "square"){return Flag::Square;}
+            if(name == "circle"){return Flag::Circle;}
+            if(name == "cross"){return Flag::Cross;}
+            if(name == "density"){return Flag::Density;}
+            throw std::invalid_argument("Unknown line style: " + name);
+        }
+    public:
+        void Add(Job job){
+            if(job.output.empty() || job.data.empty() || job.data.size() != job.color.size() || job.data.size() != job.linestyle.size()){
+                throw std::invalid_argument("Invalid job: output, data, colors and styles must be set!");
+            }
+            jobs_.push_back(std::move(job));
+        }
+        std::size_t Size() const {return jobs_.size();}
+        // Manifest lines: <output> <data>[:<style>[:<color>]] ... [| <title>]
+        // Blank lines and lines starting with '#' are skipped.
+        // Outputs ending in .svg or .pdf are written as vector files.
+        static Batch Parse(const std::string& manifest){
+            std::ifstream file(manifest);
+            if(!file){
+                throw std::runtime_error("Failed to open " + manifest);
+            }
+            Batch batch;
+            std::string line;
+            while(std::getline(file, line)){
+                std::size_t bar = line.find('|');
+                std::string title = bar == std::string::npos ? "" : line.substr(bar + 1);
+                std::stringstream stream(line.substr(0, bar));
+                Job job;
+                if(!(stream >> job.output) || job.output[0] == '#'){
+                    continue;
+                }
+                std::size_t from = title.find_first_not_of(' '), to = title.find_last_not_of(' ');
+                job.title = from == std::string::npos ? "" : title.substr(from, to - from + 1);
+                std::string token;
+                while(stream >> token){
+                    std::vector<std::string> parts;
+                    std::stringstream spec(token);
+                    std::string part;
+                    while(std::getline(spec, part, ':')){
+                        parts.push_back(part);
+                    }
+                    job.data.push_back(parts[0]);
+                    job.linestyle.push_back(parts.size() > 1 ? ParseStyle(parts[1]) : static_cast<unsigned int>(Flag::Solid));
+                    job.color.push_back(parts.size() > 2 ? ParseColor(parts[2]) : Color::Blue());
+                }
+                batch.Add(std::move(job));
+            }
+            return batch;
+        }
+        std::vector<Report> Run(Chartify::ThreadPool& pool = Chartify::ThreadPool::Shared()) const {
+            typedef std::chrono::steady_clock clock;
+            std::vector<Report> reports(jobs_.size());
+            std::vector<std::unique_ptr<Canvas>> scratch(pool.Size());
+            pool.For(jobs_.size(), [&](std::size_t i, std::size_t worker){
+                const Job& job = jobs_[i];
+                Report& report = reports[i];
+                report.output = job.output, report.worker = worker;
+                try{
+                    auto start = clock::now();
+                    std::vector<Chartify::Column> x, y;
+                    std::vector<unsigned int> linestyle;
+                    for(std::size_t k = 0; k < job.data.size(); ++k){
+                        auto data = Load(job.data[k]);
+                        report.points += data.first.Size();
+                        x.emplace_back(std::move(data.first)), y.emplace_back(std::move(data.second));
+                        linestyle.push_back(job.linestyle[k] | Flag::Decimate);
+                    }
+                    auto loaded = clock::now();
+                    std::unique_ptr<Canvas>& canvas = scratch[worker];
+                    if(!canvas || canvas->Size() != sf::Vector2u(job.width, job.height)){
+                        canvas = std::make_unique<Canvas>(std::make_unique<RenderProfile>(job.width, job.height, job.output, Mode::Headless));
+                    }
+                    canvas->ConfigurePlot(std::move(x), std::move(y), job.color, linestyle);
+                    canvas->Title(job.title);
+                    const std::size_t dot = job.output.rfind('.');
+                    const std::string extension = dot == std::string::npos ? "" : job.output.substr(dot);
+                    if(extension == ".svg" || extension == ".pdf"){
+                        canvas->Export(job.output);
+                    }
+                    else{
+                        canvas->SaveImage(job.output);
+                    }
+                    report.load_ms = std::chrono::duration<double, std::milli>(loaded - start).count();
+                    report.render_ms = std::chrono::duration<double, std::milli>(clock::now() - loaded).count();
+                }
+                catch(const std::exception& e){
+                    report.error = e.what();
+                }
+            });
+            return reports;
+        }
+    };
+};
@@ -0,0 +1,527 @@
+#define CHARTIFY_COUNT_ALLOCATIONS
+#include "matplotlib.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+using namespace matplotlib;
+namespace{
+    const unsigned int width = 1200, height = 600;
+    const sf::FloatRect plane(90, 90, 1020, 420);
+    struct Trace{
+        std::vector<double> x, y;
+    };
+    struct DashDot{
+        static constexpr float width = 2;
+        static constexpr Chartify::Cap::Type cap = Chartify::Cap::Butt;
+        static constexpr std::array<float, 4> pattern = {12, 4, 2, 4};
+    };
+    struct Record{
+        std::string stage, style;
+        std::size_t series, points, draws, vertices;
+        double ms;
+        long peak_kb;
+    };
+    long PeakKb(){
+#if defined(_WIN32)
+        return 0;
+#else
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss;
+#endif
+    }
+    long CurrentKb(){
+#if defined(__linux__)
+        long pages = 0, resident = 0;
+        if(std::FILE* statm = std::fopen("/proc/self/statm", "r")){
+            if(std::fscanf(statm, "%ld %ld", &pages, &resident) != 2){
+                resident = 0;
+            }
+            std::fclose(statm);
+        }
+        return resident * (sysconf(_SC_PAGESIZE) / 1024);
+#else
+        return PeakKb();
+#endif
+    }
+    Trace Generate(std::size_t n, unsigned int seed){
+        Trace t;
+        std::mt19937_64 rng(seed);
+        std::normal_distribution<double> noise(0, 0.1);
+        t.x.resize(n), t.y.resize(n);
+        for(std::size_t i = 0; i < n; ++i){
+            t.x[i] = static_cast<double>(i) / n * 20 - 10;
+            t.y[i] = std::sin(t.x[i] * t.x[i]) + noise(rng);
+        }
+        return t;
+    }
+    // Runs f once to warm up, then repeats it until about 100 ms have passed; returns ms per run.
+    template<class F>
+    double Time(F&& f){
+        typedef std::chrono::steady_clock clock;
+        f();
+        std::size_t runs = 0;
+        auto start = clock::now();
+        double elapsed = 0;
+        do{
+            f();
+            ++runs;
+            elapsed = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+        }while(elapsed < 100 && runs < 100);
+        return elapsed / runs;
+    }
+    std::string StyleName(unsigned int style){
+        std::string name;
+        switch(style & Flag::Line){
+            case Flag::Solid: name = "solid";
+            break;
+            case Flag::Dashed: name = "dashed";
+            break;
+            case Flag::Dotted: name = "dotted";
+            break;
+        }
+        if(style & Flag::Density){
+            return "density";
+        }
+        switch(style & Flag::Marker){
+            case Flag::Point: name += name.empty() ? "point" : "+point";
+            break;
+            case Flag::Square: name += name.empty() ? "square" : "+square";
+            break;
+            case Flag::Circle: name += name.empty() ? "circle" : "+circle";
+            break;
+            case Flag::Cross: name += name.empty() ? "cross" : "+cross";
+            break;
+        }
+        return name;
+    }
+    class Suite{
+        std::vector<Record> records_;
+    public:
+        void Add(const std::string& stage, const std::string& style, std::size_t series, std::size_t points, double ms, std::size_t draws = 0, std::size_t vertices = 0){
+            records_.push_back(Record{stage, style, series, points, draws, vertices, ms, PeakKb()});
+            const Record& r = records_.back();
+            std::fprintf(stderr, "%-12s %-10s %4zu x %-10zu %12.3f ms %10.3f ns/point %6zu draws %10zu verts %8ld KB\n", r.stage.c_str(), r.style.c_str(), r.series, r.points, r.ms, r.ms * 1e6 / std::max<std::size_t>(1, r.series * r.points), r.draws, r.vertices, r.peak_kb);
+        }
+        void Json(std::FILE* out) const {
+            std::fprintf(out, "[\n");
+            for(std::size_t i = 0; i < records_.size(); ++i){
+                const Record& r = records_[i];
+                std::fprintf(out, "  {\"stage\": \"%s\", \"style\": \"%s\", \"series\": %zu, \"points\": %zu, \"ms\": %.6f, \"ns_per_point\": %.4f, \"draw_calls\": %zu, \"vertices\": %zu, \"peak_kb\": %ld}%s\n",
+                    r.stage.c_str(), r.style.c_str(), r.series, r.points, r.ms, r.ms * 1e6 / std::max<std::size_t>(1, r.series * r.points), r.draws, r.vertices, r.peak_kb, i + 1 < records_.size() ? "," : "");
+            }
+            std::fprintf(out, "]\n");
+        }
+    };
+    void Engine(Suite& suite, const std::vector<Trace>& traces, std::size_t n){
+        const std::size_t s = traces.size();
+        std::vector<std::vector<sf::Vertex>> projected(s, std::vector<sf::Vertex>(n));
+        std::vector<Chartify::Affine> affine(s);
+        suite.Add("bounds", "", s, n, Time([&]{
+            for(std::size_t i = 0; i < s; ++i){
+                auto bx = Chartify::Kernel::Bounds(traces[i].x.data(), n), by = Chartify::Kernel::Bounds(traces[i].y.data(), n);
+                affine[i] = Chartify::Affine::Fit(bx.first, bx.second, by.first, by.second, plane);
+            }
+        }));
+        std::vector<sf::Vertex> legacy;
+        suite.Add("projection", "scalar", s, n, Time([&]{
+            for(std::size_t i = 0; i < s; ++i){
+                const Trace& t = traces[i];
+                legacy.clear();
+                auto it_x = std::minmax_element(t.x.begin(), t.x.end());
+                auto it_y = std::minmax_element(t.y.begin(), t.y.end());
+                double u = *it_x.second - *it_x.first, v = *it_y.second - *it_y.first;
+                for(std::size_t l = 0; l < n; ++l){
+                    float scr_x = plane.left + ((t.x[l] - *it_x.first) / u) * plane.width;
+                    float scr_y = plane.top + plane.height * (1 - ((t.y[l] - *it_y.first) / v));
+                    legacy.emplace_back(sf::Vector2f(scr_x, scr_y), sf::Color::Blue);
+                }
+            }
+        }));
+        suite.Add("projection", "kernel", s, n, Time([&]{
+            for(std::size_t i = 0; i < s; ++i){
+                Chartify::Kernel::Project(traces[i].x.data(), traces[i].y.data(), n, affine[i], sf::Color::Blue, projected[i].data());
+            }
+        }));
+        std::vector<sf::Vertex> reduced;
+        double ms = Time([&]{
+            for(std::size_t i = 0; i < s; ++i){
+                reduced.clear();
+                Chartify::Decimator m4(reduced, sf::Color::Blue);
+                for(const sf::Vertex& v : projected[i]){
+                    m4.Push(v.position);
+                }
+            }
+        });
+        suite.Add("decimate", "", s, n, ms, 0, reduced.size());
+        sf::VertexArray stroke;
+        const std::pair<const char*, Chartify::Stroke::Painter> painters[] = {
+            {"solid", Chartify::Stroke::Of<Chartify::Style::Solid>()}, {"dashed", Chartify::Stroke::Of<Chartify::Style::Dashed>()},
+            {"dotted", Chartify::Stroke::Of<Chartify::Style::Dotted>()}, {"dashdot", Chartify::Stroke::Of<DashDot>()}
+        };
+        for(const auto& painter : painters){
+            ms = Time([&]{
+                for(std::size_t i = 0; i < s; ++i){
+                    stroke.clear();
+                    painter.second(projected[i].data(), n, sf::Color::Blue, stroke, nullptr, 0);
+                }
+            });
+            suite.Add("stroke", painter.first, s, n, ms, 0, stroke.getVertexCount());
+        }
+    }
+    void Chart(Suite& suite, const std::vector<Trace>& traces, std::size_t n, bool title){
+        const std::size_t s = traces.size();
+        const unsigned int styles[] = {Flag::Solid, Flag::Dashed, Flag::Dotted, Flag::Solid | Flag::Decimate, Flag::Dashed | Flag::Decimate, Flag::Dotted | Flag::Decimate,
+            Flag::Point, Flag::Circle, Flag::Cross, Flag::Density};
+        for(unsigned int style : styles){
+            Canvas canvas(std::make_unique<RenderProfile>(width, height, "benchmark", Mode::Headless));
+            std::vector<Chartify::Column> x, y;
+            for(const Trace& t : traces){
+                x.push_back(Chartify::Column::View(t.x.data(), n)), y.push_back(Chartify::Column::View(t.y.data(), n));
+            }
+            std::string name = StyleName(style) + (style & Flag::Decimate ? "+m4" : "");
+            double ms = Time([&]{
+                canvas.ConfigurePlot(x, y, std::vector<Color>(s, Color::Blue()), std::vector<unsigned int>(s, style));
+                canvas.Plot();
+            });
+            suite.Add("plot", name, s, n, ms, canvas.Profile().DrawCalls());
+            ms = Time([&]{
+                canvas.Invalidate(Dirty::Style);
+                canvas.Plot();
+            });
+            suite.Add("restroke", name, s, n, ms, canvas.Profile().DrawCalls());
+            ms = Time([&]{
+                canvas.Plot();
+            });
+            suite.Add("present", name, s, n, ms, canvas.Profile().DrawCalls());
+            canvas.Zoom(0.01, sf::Vector2f(width / 2, height / 2));
+            ms = Time([&]{
+                canvas.Invalidate(Dirty::View);
+                canvas.Plot();
+            });
+            suite.Add("zoom", name, s, n, ms, canvas.Profile().DrawCalls());
+            canvas.Home();
+            if(title){
+                ms = Time([&]{
+                    canvas.Title("Benchmark title");
+                    canvas.Plot();
+                });
+                suite.Add("title", name, s, n, ms, canvas.Profile().DrawCalls());
+            }
+        }
+    }
+    // A 4x4 dashboard in one headless figure: the first frame builds every panel, a clean frame
+    // only redraws, and a frame after one panel changed rebuilds only that panel.
+    void Dashboard(Suite& suite, const Trace& trace, std::size_t n){
+        const std::size_t rows = 4, cols = 4;
+        Figure figure(rows, cols, std::make_unique<RenderProfile>(width, height, "benchmark", Mode::Headless));
+        double ms = Time([&]{
+            for(std::size_t r = 0; r < rows; ++r){
+                for(std::size_t c = 0; c < cols; ++c){
+                    figure.Subplot(r, c).ConfigurePlot({Chartify::Column::View(trace.x.data(), n)}, {Chartify::Column::View(trace.y.data(), n)}, {Color::Blue()}, {Flag::Solid | Flag::Decimate});
+                }
+            }
+            figure.Plot();
+        });
+        suite.Add("figure", "4x4", rows * cols, n, ms, figure.Profile().DrawCalls());
+        ms = Time([&]{
+            figure.Plot();
+        });
+        suite.Add("present", "4x4", rows * cols, n, ms, figure.Profile().DrawCalls());
+        ms = Time([&]{
+            figure.Subplot(1, 2).Invalidate(Dirty::Style);
+            figure.Plot();
+        });
+        suite.Add("panel", "4x4", rows * cols, n, ms, figure.Profile().DrawCalls());
+    }
+    // One 8K frame of the same chart through SFML and through the tile-parallel CPU rasterizer.
+    void Poster(Suite& suite, const Trace& trace, std::size_t n){
+        const unsigned int poster_width = 7680, poster_height = 4320;
+        for(Backend::Type backend : {Backend::Gpu, Backend::Raster}){
+            Canvas canvas(std::make_unique<RenderProfile>(poster_width, poster_height, "benchmark", Mode::Headless, backend));
+            canvas.ConfigurePlot({Chartify::Column::View(trace.x.data(), n)}, {Chartify::Column::View(trace.y.data(), n)}, {Color::Blue()}, {Flag::Solid | Flag::Decimate});
+            canvas.Plot();
+            double ms = Time([&]{
+                canvas.Invalidate(Dirty::Style);
+                canvas.Plot();
+                canvas.Profile().Capture();
+            });
+            suite.Add("8k", backend == Backend::Raster ? "raster" : "gpu", 1, n, ms, canvas.Profile().DrawCalls(), canvas.Profile().Vertices());
+        }
+    }
+    // Builds the min/max pyramid of a trace, then redraws the full view from the samples and
+    // from the pyramid.
+    void Summaries(Suite& suite, const Trace& trace, std::size_t n){
+        const std::string path = "benchmark.pyramid";
+        const Chartify::Column x = Chartify::Column::View(trace.x.data(), n), y = Chartify::Column::View(trace.y.data(), n);
+        suite.Add("pyramid", "build", 1, n, Time([&]{
+            Chartify::Pyramid::Build(x, y, path);
+        }));
+        for(bool indexed : {false, true}){
+            Canvas canvas(std::make_unique<RenderProfile>(width, height, "benchmark", Mode::Headless));
+            canvas.ConfigurePlot({x}, {y}, {Color::Blue()}, {Flag::Solid | Flag::Decimate});
+            if(indexed){
+                canvas.Index(0, path);
+            }
+            double ms = Time([&]{
+                canvas.Invalidate(Dirty::Data);
+                canvas.Plot();
+            });
+            suite.Add("pyramid", indexed ? "indexed" : "raw", 1, n, ms, canvas.Profile().DrawCalls(), canvas.Profile().Vertices());
+        }
+        std::remove(path.c_str());
+    }
+    // Drives a headless canvas through a repeating cycle of zoom, pan and restroke frames while a
+    // stream series keeps receiving points. After two warm-up cycles every frame has to be free of
+    // heap allocations and resident memory has to stay flat.
+    bool Soak(double seconds){
+        typedef std::chrono::steady_clock clock;
+        const std::size_t n = 100000, cycle = 64, warmup = 2 * cycle, batch = 256;
+        std::vector<Trace> traces;
+        std::vector<Chartify::Column> x, y;
+        for(unsigned int i = 0; i < 3; ++i){
+            traces.push_back(Generate(n, i));
+        }
+        for(const Trace& t : traces){
+            x.push_back(Chartify::Column::View(t.x.data(), n)), y.push_back(Chartify::Column::View(t.y.data(), n));
+        }
+        Canvas canvas(std::make_unique<RenderProfile>(width, height, "soak", Mode::Headless));
+        canvas.ConfigurePlot(x, y, {Color::Blue(), Color::Green(), Color::Orange()}, {Flag::Solid | Flag::Decimate, Flag::Dashed, Flag::Dotted});
+        std::size_t stream = canvas.AddStream(8192, Color::Red(), Flag::Solid);
+        canvas.Profiling(true);
+        std::vector<double> sx(batch), sy(batch);
+        const sf::Vector2f center(width / 2, height / 2);
+        std::size_t frames = 0, allocations = 0;
+        long rss = 0;
+        double appended = 0;
+        auto start = clock::now();
+        while(frames < warmup + cycle || std::chrono::duration<double>(clock::now() - start).count() < seconds){
+            std::size_t phase = frames % cycle;
+            if(phase == 0){
+                canvas.Home();
+            }
+            if(phase < 16){
+                canvas.Zoom(0.8, center);
+            }
+            else if(phase < 32){
+                canvas.Pan(sf::Vector2f(phase % 2 ? 40.0f : -40.0f, 10.0f));
+            }
+            else if(phase < 48){
+                canvas.Zoom(1.25, center);
+            }
+            else{
+                canvas.Invalidate(Dirty::Style);
+            }
+            for(std::size_t k = 0; k < batch; ++k, ++appended){
+                sx[k] = appended * 1e-3, sy[k] = std::sin(appended * 1e-2);
+            }
+            canvas.AppendPoints(stream, sx.data(), sy.data(), batch);
+            canvas.Plot();
+            if(++frames == warmup){
+                rss = CurrentKb();
+            }
+            else if(frames > warmup){
+                allocations += canvas.Stats().Last().allocations;
+            }
+        }
+        long grown = CurrentKb() - rss;
+        bool flat = allocations == 0 && grown <= 1024;
+        std::fprintf(stderr, "soak %s: %zu frames, %zu allocations after warm-up, resident %ld KB -> %+ld KB\n", flat ? "passed" : "FAILED", frames, allocations, rss, grown);
+        return flat;
+    }
+    // Several producer threads push into a canvas feed as fast as they can while the main thread
+    // renders. Every accepted sample has to reach its stream exactly once and in push order, and
+    // both sides have to keep making progress.
+    bool Stress(double seconds){
+        typedef std::chrono::steady_clock clock;
+        const std::size_t producers = 4, capacity = 1 << 16;
+        Canvas canvas(std::make_unique<RenderProfile>(width, height, "benchmark", Mode::Headless));
+        for(std::size_t p = 0; p < producers; ++p){
+            canvas.AddStream(capacity, Color::Blue(), Flag::Solid | Flag::Decimate);
+        }
+        Chartify::Queue<Chartify::Sample>& feed = canvas.Feed(capacity);
+        std::atomic<bool> stop{false};
+        std::vector<std::size_t> pushed(producers, 0);
+        std::vector<double> slowest(producers, 0);
+        std::vector<std::thread> threads;
+        for(std::size_t p = 0; p < producers; ++p){
+            threads.emplace_back([&, p]{
+                std::size_t sequence = 0;
+                while(!stop.load(std::memory_order_relaxed)){
+                    auto start = clock::now();
+                    for(std::size_t k = 0; k < 1024; ++k, ++sequence){
+                        pushed[p] += feed.Push(Chartify::Sample{p, static_cast<double>(sequence), std::sin(sequence * 1e-3)});
+                    }
+                    slowest[p] = std::max(slowest[p], std::chrono::duration<double, std::micro>(clock::now() - start).count() / 1024);
+                }
+            });
+        }
+        std::size_t frames = 0;
+        double worst = 0;
+        const auto deadline = clock::now() + std::chrono::duration<double>(seconds);
+        while(clock::now() < deadline){
+            auto start = clock::now();
+            canvas.Plot();
+            worst = std::max(worst, std::chrono::duration<double, std::milli>(clock::now() - start).count());
+            ++frames;
+        }
+        stop = true;
+        for(std::thread& t : threads){
+            t.join();
+        }
+        while(!feed.Empty()){
+            canvas.Plot();
+        }
+        std::size_t accepted = 0;
+        double slowest_push = 0;
+        for(std::size_t p = 0; p < producers; ++p){
+            accepted += pushed[p], slowest_push = std::max(slowest_push, slowest[p]);
+        }
+        bool ordered = true;
+        for(std::size_t p = 0; p < producers; ++p){
+            double last = -1;
+            canvas.Stream(p).Segments([&](const double* x, const double*, std::size_t n){
+                for(std::size_t i = 0; i < n; ++i){
+                    ordered = ordered && x[i] > last;
+                    last = x[i];
+                }
+            });
+        }
+        bool passed = ordered && accepted == canvas.Ingested() && frames > 0 && accepted > 0;
+        std::fprintf(stderr, "stress %s: %zu frames (worst %.2f ms), %zu samples accepted, %llu ingested, %llu dropped on a full queue, max %.3f us/push, order %s\n",
+            passed ? "passed" : "FAILED", frames, worst, accepted, static_cast<unsigned long long>(canvas.Ingested()), static_cast<unsigned long long>(feed.Dropped()), slowest_push, ordered ? "kept" : "BROKEN");
+        return passed;
+    }
+}
+int main(int argc, char** argv){
+    std::size_t limit = 10000000, budget = 40000000;
+    std::vector<std::size_t> counts = {1, 4};
+    bool json = false, title = false;
+    double soak = 0, stress = 0;
+    const char* output = nullptr;
+    for(int i = 1; i < argc; ++i){
+        if(!std::strcmp(argv[i], "--max") && i + 1 < argc){
+            limit = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if(!std::strcmp(argv[i], "--series") && i + 1 < argc){
+            counts.clear();
+            for(char* p = argv[++i]; *p; ){
+                counts.push_back(std::strtoull(p, &p, 10));
+                p += *p == ',';
+            }
+        }
+        else if(!std::strcmp(argv[i], "--json")){
+            json = true;
+        }
+        else if(!std::strcmp(argv[i], "--output") && i + 1 < argc){
+            output = argv[++i], json = true;
+        }
+        else if(!std::strcmp(argv[i], "--title")){
+            title = true;
+        }
+        else if(!std::strcmp(argv[i], "--soak") && i + 1 < argc){
+            soak = std::strtod(argv[++i], nullptr);
+        }
+        else if(!std::strcmp(argv[i], "--stress") && i + 1 < argc){
+            stress = std::strtod(argv[++i], nullptr);
+        }
+        else{
+            std::fprintf(stderr, "usage: %s [--max N] [--series 1,4,...] [--json] [--output FILE] [--title] [--soak SECONDS] [--stress SECONDS]\n", argv[0]);
+            return 2;
+        }
+    }
+    if(title && !Chartify::Fonts::Find()){
+        std::fprintf(stderr, "title stage skipped: no font at Font/font.ttf\n");
+        title = false;
+    }
+    if(soak > 0){
+        return Soak(soak) ? 0 : 1;
+    }
+    if(stress > 0){
+        return Stress(stress) ? 0 : 1;
+    }
+    Suite suite;
+    {
+        Canvas canvas(std::make_unique<RenderProfile>(width, height, "benchmark", Mode::Headless));
+        double ms = Time([&]{
+            canvas.Invalidate(Dirty::Style);
+            canvas.Plot();
+        });
+        suite.Add("grid", "", 0, 0, ms, canvas.Profile().DrawCalls());
+    }
+    for(std::size_t n = 1000; n <= limit; n *= 10){
+        for(std::size_t s : counts){
+            if(s == 0 || s * n > budget){
+                continue;
+            }
+            std::vector<Trace> traces;
+            for(std::size_t i = 0; i < s; ++i){
+                traces.push_back(Generate(n, static_cast<unsigned int>(i)));
+            }
+            Engine(suite, traces, n);
+            Chart(suite, traces, n, title);
+            if(s == 1){
+                Dashboard(suite, traces[0], n);
+                Poster(suite, traces[0], n);
+                Summaries(suite, traces[0], n);
+            }
+        }
+    }
+    Chartify::Ring ring(1 << 20, 1000);
+    const std::size_t appends = 10000000;
+    std::size_t appended = 0;
+    suite.Add("append", "ring", 1, appends, Time([&]{
+        for(std::size_t i = 0; i < appends; ++i, ++appended){
+            ring.Append(appended * 1e-4, std::sin(appended * 1e-3));
+        }
+    }));
+    {
+        // Model functions with about a microsecond of extra work per call, sampled once at
+        // uniform half-pixel steps across the plane and once adaptively, as PlotFunction does.
+        Chartify::Sampler sampler;
+        auto cost = [](double x){
+            volatile double sink = x;
+            for(int k = 0; k < 200; ++k){
+                sink = sink + 1;
+            }
+            return sink - x - 200;
+        };
+        auto smooth = [&](double x){return std::sin(x) + cost(x);};
+        auto chirp = [&](double x){return std::sin(x * x * x) + cost(x);};
+        const std::size_t uniform = 2 * static_cast<std::size_t>(plane.width) + 1;
+        suite.Add("function", "uniform", 1, uniform, Time([&]{
+            for(std::size_t i = 0; i < uniform; ++i){
+                chirp(-10 + 20.0 * i / (uniform - 1));
+            }
+        }));
+        double ms = Time([&]{sampler.Run(smooth, -10, 10, plane.width, plane.height);});
+        suite.Add("function", "smooth", 1, sampler.Evaluations(), ms);
+        ms = Time([&]{sampler.Run(chirp, -10, 10, plane.width, plane.height);});
+        suite.Add("function", "chirp", 1, sampler.Evaluations(), ms);
+    }
+    if(json){
+        std::FILE* out = output ? std::fopen(output, "w") : stdout;
+        if(!out){
+            std::fprintf(stderr, "Failed to open %s\n", output);
+            return 1;
+        }
+        suite.Json(out);
+        if(output){
+            std::fclose(out);
+        }
+    }
+    return 0;
+}
@@ -4,6 +4,11 @@
 #include <vector>
 #include <iterator>
 #include <cmath>
+#include <cstdio>
+#include "stroke.h"
+#include "font.h"
+#include "arena.h"
+#include "series.h"
 namespace Chartify{
     struct Screen{
         enum Size{
@@ -90,139 +95,149 @@ namespace Chartify{
         std::unique_ptr<RenderProfile> profile_;
         Color fone_, grid_, axes_;
         unsigned int flag_;
-        std::vector<std::vector<double>> x_, y_;
+        std::vector<Column> x_, y_;
         std::vector<Color> color_;
         std::vector<unsigned int> linestyle_;
+        std::vector<Stroke::Painter> painter_;
         const float space_ = 70.0f;
         const unsigned int fontsize_ = 18;
-        sf::Font font_;
         sf::String title_;
+        // Tick labels, title and readout, laid out for the range and size they were built for.
+        struct Labels{
+            double x0, x1, y0, y1;
+            sf::Vector2u size;
+            bool valid;
+        };
+        mutable Labels labels_{0, 0, 0, 0, sf::Vector2u(), false};
+        mutable Glyphs ticks_, text_;
+        // Per-frame scratch: projected points come from the arena, reset at the start of every frame, and
+        // the stroke buffer keeps its capacity between series and frames.
+        mutable Arena arena_;
+        mutable sf::VertexArray stroke_;
+        void Layout(double x0, double x1, double y0, double y1) const {
+            const sf::Font* font = Fonts::Find();
+            ticks_.Reset(font, fontsize_ - 4), text_.Reset(font, fontsize_);
+            char value[64];
+            auto label = [&](float v, float x, float y){
+                std::snprintf(value, sizeof(value), "%f", v);
+                value[4] = '\0';
+                ticks_.Add(value, sf::Vector2f(x, y), axes_.Data());
+            };
+            if(flag_ & Flag::Grid){
+                for(int v = space_; v <= profile_->Data().x - space_; v += (profile_->Data().x - 2 * space_)/ 10){
+                    label(x0 + ((v - space_) / (profile_->Data().x - 2 * space_)) * (x1 - x0), v - 10, profile_->Data().y - space_ + 5);
+                }
+                for(int h = space_; h <= profile_->Data().y - space_; h += (profile_->Data().y - 2 * space_)/ 10){
+                    label(y1 - ((h - space_) / (profile_->Data().y - 2 * space_)) * (y1 - y0), space_ - 35, h - 10);
+                }
+            }
+            if(!title_.isEmpty()){
+                float width = text_.Measure(title_).x;
+                text_.Add(title_, sf::Vector2f((profile_->Data().x - width) / 2, space_ / 2), Color::Black().Data());
+            }
+            text_.Add("(x, y) = ", sf::Vector2f(profile_->Data().x - 2.5 * space_, space_ / 2), Color::Black().Data());
+            labels_ = Labels{x0, x1, y0, y1, profile_->Data(), true};
+        }
     public:
         Canvas() : profile_(std::make_unique<RenderProfile>(Screen::Width, Screen::Height, sf::String("As Chartify!"))), fone_(Color::White()), grid_(Color({Color({180, 180, 180}, 200)})),
         axes_(Color::Black()), flag_(Flag::Axes | Flag::Grid){}
-        void ConfigurePlot(const std::vector<std::vector<double>>& x, const std::vector<std::vector<double>>& y, const std::vector<Color>& color, const std::vector<unsigned int>& linestyle){
+        // Replaces the plotted series. Columns are shared, not copied; see series.h.
+        void ConfigurePlot(std::vector<Column> x, std::vector<Column> y, const std::vector<Color>& color, const std::vector<unsigned int>& linestyle){
             if(x.size() != y.size() || x.size() != color.size() || x.size() != linestyle.size() || x.empty() || y.empty()){
                 throw std::invalid_argument("Invalid vectors data: sizes are different, or vectors are empty!");
             }
             for(std::size_t i = 0; i < x.size(); ++i){
-                if(x[i].size() != y[i].size() || x[i].size() <= 2 || y[i].size() <= 2){
+                if(x[i].Size() != y[i].Size() || x[i].Size() <= 2 || y[i].Size() <= 2){
                     throw std::invalid_argument("Invalid vectors data: to low to create graph or subvector sizes are different!");
                 }
-                x_.push_back(x[i]), y_.push_back(y[i]);
             }
+            x_ = std::move(x), y_ = std::move(y);
             color_ = color;
             linestyle_ = linestyle;
+            painter_.clear();
+            for(unsigned int style : linestyle_){
+                switch(style){
+                    case Flag::Solid: painter_.push_back(Stroke::Of<Style::Solid>());
+                    break;
+                    case Flag::Dashed: painter_.push_back(Stroke::Of<Style::Dashed>());
+                    break;
+                    case Flag::Dotted: painter_.push_back(Stroke::Of<Style::Dotted>());
+                    break;
+                    default: painter_.push_back(nullptr);
+                }
+            }
+        }
+        void ConfigurePlot(const std::vector<std::vector<double>>& x, const std::vector<std::vector<double>>& y, const std::vector<Color>& color, const std::vector<unsigned int>& linestyle){
+            std::vector<Column> cx, cy;
+            for(const std::vector<double>& row : x){
+                cx.push_back(Column::Copy(row, Precision::Double));
+            }
+            for(const std::vector<double>& row : y){
+                cy.push_back(Column::Copy(row, Precision::Double));
+            }
+            ConfigurePlot(std::move(cx), std::move(cy), color, linestyle);
+        }
+        void ConfigurePlot(std::vector<std::vector<double>>&& x, std::vector<std::vector<double>>&& y, const std::vector<Color>& color, const std::vector<unsigned int>& linestyle){
+            std::vector<Column> cx, cy;
+            for(std::vector<double>& row : x){
+                cx.emplace_back(std::move(row));
+            }
+            for(std::vector<double>& row : y){
+                cy.emplace_back(std::move(row));
+            }
+            ConfigurePlot(std::move(cx), std::move(cy), color, linestyle);
         }
         void Plot() const {
             const float extra_space = 20.0f;
-            std::vector<std::pair<std::vector<double>::const_iterator, std::vector<double>::const_iterator>> it_x, it_y;
+            typedef std::pair<double, double> Range;
+            auto range = [](const Column& c){
+                return c.Visit([&](auto p){
+                    auto it = std::minmax_element(p, p + c.Size());
+                    return Range(*it.first, *it.second);
+                });
+            };
+            arena_.Reset();
+            Range* it_x = arena_.Allocate<Range>(x_.size());
+            Range* it_y = arena_.Allocate<Range>(y_.size());
             profile_->Profile().clear(fone_.Data());
             for(std::size_t i = 0; i < x_.size(); ++i){
-                it_x.push_back(std::minmax_element(x_[i].begin(), x_[i].end()));
-                it_y.push_back(std::minmax_element(y_[i].begin(), y_[i].end()));
-                double u = *it_x[i].second - *it_x[i].first;
-                double v = *it_y[i].second - *it_y[i].first;
+                it_x[i] = range(x_[i]);
+                it_y[i] = range(y_[i]);
+                double u = it_x[i].second - it_x[i].first;
+                double v = it_y[i].second - it_y[i].first;
                 if(u == 0 || v == 0){
                     u = 1;
                     v = 1;
                 }
-                std::vector<sf::Vertex> chart;
-                for(std::size_t l = 0; l < x_[i].size(); ++l){
-                    float scr_x = space_ + extra_space + ((x_[i][l] - *it_x[i].first) / (u)) * (profile_->Data().x - 2 * space_ - extra_space * 2);
-                    float scr_y = space_ + extra_space + (profile_->Data().y - 2 * space_ - 2 * extra_space) * (1 - ((y_[i][l] - *it_y[i].first) / (v)));
-                    chart.emplace_back(sf::Vector2f(scr_x, scr_y), color_[i].Data());
-                }
-                switch(linestyle_[i]){
-                    case Flag::Solid:{
-                        const float spacing = 0.5f;
-                        const float R = 1.0f;
-                        for(std::size_t q = 1; q < chart.size(); ++q){
-                            const sf::Vector2f& iu = chart[q - 1].position, iv = chart[q].position;
-                            sf::Vector2f div = iv - iu;
-                            float segment_len = std::sqrt(div.x * div.x + div.y * div.y);
-                            div /= segment_len;
-                            for(float s = 0.0f; s < segment_len; s += spacing){
-                                sf::Vector2f dx = iu + div * s;
-                                sf::CircleShape dot(R);
-                                dot.setPosition(dx);
-                                dot.setFillColor(color_[i].Data());
-                                profile_->Profile().draw(dot);
-                            }
-                        }
-                    }
-                    break;
-                    case Flag::Dashed:{
-                        const float R = 1.0f;
-                        const float dash_len = 10.0f;
-                        const float gap_len = 5.0f;
-                        for(std::size_t k = 1; k < chart.size(); ++k){
-                            const sf::Vector2f& iu = chart[k - 1].position, iv = chart[k].position;
-                            sf::Vector2f div = iv - iu;
-                            float segment_len = std::sqrt(div.x * div.x + div.y * div.y);
-                            div /= segment_len;
-                            float drawn = 0;
-                            bool dash_drawn = true;
-                            while(drawn < segment_len) {
-                                float step = dash_drawn ? dash_len : gap_len;
-                                float current_step = std::min(step, segment_len - drawn);
-                                sf::Vector2f start = iu + div * drawn;
-                                sf::Vector2f end = iu + div * (drawn + current_step);
-                                if(dash_drawn) {
-                                    for(float s = 0; s < current_step; s += 0.5f) {
-                                        sf::Vector2f pos = iu + div * (drawn + s);
-                                        sf::CircleShape dot(R);
-                                        dot.setPosition(pos.x - R, pos.y - R);
-                                        dot.setFillColor(color_[i].Data());
-                                        profile_->Profile().draw(dot);
-                                    }
-                                }
-                                drawn += current_step;
-                                dash_drawn = !dash_drawn;
-                            }
-                        }
-                    }
-                    break;
-                    case Flag::Dotted:{
-                        const float spacing = 7.0f;
-                        const float R = 2.0f;
-                        for(std::size_t q = 1; q < chart.size(); ++q){
-                            const sf::Vector2f& iu = chart[q - 1].position, iv = chart[q].position;
-                            sf::Vector2f div = iv - iu;
-                            float segment_len = std::sqrt(div.x * div.x + div.y * div.y);
-                            div /= segment_len;
-                            for(float s = 0.0f; s < segment_len; s += spacing){
-                                sf::Vector2f dx = iu + div * s;
-                                sf::CircleShape dot(R);
-                                dot.setPosition(dx);
-                                dot.setFillColor(color_[i].Data());
-                                profile_->Profile().draw(dot);
-                            }
-                        }
+                const std::size_t n = x_[i].Size();
+                sf::Vertex* chart = arena_.Allocate<sf::Vertex>(n);
+                Visit(x_[i], y_[i], [&](auto px, auto py){
+                    for(std::size_t l = 0; l < n; ++l){
+                        float scr_x = space_ + extra_space + ((px[l] - it_x[i].first) / (u)) * (profile_->Data().x - 2 * space_ - extra_space * 2);
+                        float scr_y = space_ + extra_space + (profile_->Data().y - 2 * space_ - 2 * extra_space) * (1 - ((py[l] - it_y[i].first) / (v)));
+                        chart[l] = sf::Vertex(sf::Vector2f(scr_x, scr_y), color_[i].Data());
                     }
-                    break;
+                });
+                stroke_.clear();
+                if(painter_[i]){
+                    painter_[i](chart, n, color_[i].Data(), stroke_, nullptr, 0);
                 }
+                profile_->Profile().draw(stroke_);
+            }
+            const double x0 = it_x[0].first, x1 = it_x[0].second, y0 = it_y[0].first, y1 = it_y[0].second;
+            if(!labels_.valid || labels_.x0 != x0 || labels_.x1 != x1 || labels_.y0 != y0 || labels_.y1 != y1 || labels_.size != profile_->Data()){
+                Layout(x0, x1, y0, y1);
             }
             if(flag_ & Flag::Grid){
                 for(int v = space_; v <= profile_->Data().x - space_; v += (profile_->Data().x - 2 * space_)/ 10){
                     sf::Vertex vl[] = {sf::Vertex(sf::Vector2f(v, space_), grid_.Data()), sf::Vertex(sf::Vector2f(v, (profile_->Data().y - space_)), grid_.Data())};
                     profile_->Profile().draw(vl, 2, sf::LineStrip);
-                    
-                    float x_value = *it_x[0].first + ((v - space_) / (profile_->Data().x - 2 * space_)) * (*it_x[0].second - *it_x[0].first);
-                    sf::Text x_label(std::to_string(x_value).substr(0, 4), font_, fontsize_ - 4);
-                    x_label.setFillColor(axes_.Data());
-                    x_label.setPosition(v - 10, profile_->Data().y - space_ + 5);
-                    profile_->Profile().draw(x_label);
                 }
                 for(int h = space_; h <= profile_->Data().y - space_; h += (profile_->Data().y - 2 * space_)/ 10){
                     sf::Vertex hl[] = {sf::Vertex(sf::Vector2f(space_, h), grid_.Data()), sf::Vertex(sf::Vector2f(profile_->Data().x - space_, h), grid_.Data())};
                     profile_->Profile().draw(hl, 2, sf::LineStrip);
-                    
-                    float y_value = *it_y[0].second - ((h - space_) / (profile_->Data().y - 2 * space_)) * (*it_y[0].second - *it_y[0].first);
-                    sf::Text y_label(std::to_string(y_value).substr(0, 4), font_, fontsize_ - 4);
-                    y_label.setFillColor(axes_.Data());
-                    y_label.setPosition(space_ - 35, h - 10);
-                    profile_->Profile().draw(y_label);
                 }
+                profile_->Profile().draw(ticks_);
             }
             if(flag_ & Flag::Axes){
                 int x = space_;
@@ -231,42 +246,35 @@ namespace Chartify{
                 sf::Vertex yl[] = {sf::Vertex(sf::Vector2f(x, space_), axes_.Data()), sf::Vertex(sf::Vector2f(x, profile_->Data().y - space_), axes_.Data())};
                 profile_->Profile().draw(xl, 2, sf::LineStrip), profile_->Profile().draw(yl, 2, sf::LineStrip);
             }
-            if(!title_.isEmpty()){
-                if(title_.getSize() > profile_->Data().x){
-                    throw std::invalid_argument("Too low signs to make title!");
-                }
-                sf::Text text(title_, font_, fontsize_);
-                sf::FloatRect text_bound = text.getGlobalBounds();
-                float xPos = (profile_->Data().x - text_bound.width) / 2;
-                text.setFillColor(Color::Black().Data());
-                text.setPosition(xPos, space_ / 2);
-                profile_->Profile().draw(text);
+            if(!title_.isEmpty() && title_.getSize() > profile_->Data().x){
+                throw std::invalid_argument("Too low signs to make title!");
             }
-            sf::Text c(sf::String("(x, y) = "), font_, fontsize_);
-            c.setFillColor(Color::Black().Data());
-            c.setPosition(profile_->Data().x - 2.5 * space_, space_ / 2);
-            profile_->Profile().draw(c);
+            profile_->Profile().draw(text_);
             profile_->Profile().display();
         }
         void Title(const sf::String& title) {
-            font_.loadFromFile("Font/font.ttf");
-            if(!font_.loadFromFile("Font/font.ttf")){
+            if(!Fonts::Find()){
                 throw std::invalid_argument("Font didn't been installed!");
             }
             title_ = title;
+            labels_.valid = false;
         }
         void Show() const {
             sf::RenderWindow& s = profile_->Profile();
-            while(s.isOpen()){
-                sf::Event event;
-                while(s.pollEvent(event)){
-                    switch(event.type){
-                        case sf::Event::Closed:
-                            s.close();
-                            break;
-                    }
+            sf::Event event;
+            Plot();
+            while(s.isOpen() && s.waitEvent(event)){
+                switch(event.type){
+                    case sf::Event::Closed:
+                        s.close();
+                        break;
+                    case sf::Event::Resized:
+                    case sf::Event::GainedFocus:
+                        Plot();
+                        break;
+                    default:
+                        break;
                 }
-                Plot();
             }
         }
         virtual ~Canvas() = default;
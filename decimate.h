@@ -0,0 +1,61 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+namespace Chartify{
+    // Streaming M4 reduction of a projected polyline: every run of consecutive points that
+    // falls into the same pixel column is replaced by its first, min, max and last point,
+    // in their original order. The rasterized line stays the same while the stroke stage
+    // only sees O(plot width) vertices.
+    class Decimator{
+        std::vector<sf::Vertex>& out_;
+        sf::Color color_;
+        long column_ = 0;
+        std::size_t count_ = 0, index_min_ = 0, index_max_ = 0;
+        sf::Vector2f first_, min_, max_, last_;
+        void Emit(const sf::Vector2f& p){
+            if(out_.empty() || out_.back().position != p){
+                out_.emplace_back(p, color_);
+            }
+        }
+    public:
+        Decimator(std::vector<sf::Vertex>& out, const sf::Color& color) : out_(out), color_(color){}
+        Decimator(const Decimator&) = delete;
+        Decimator& operator=(const Decimator&) = delete;
+        void Push(const sf::Vector2f& p){
+            long column = static_cast<long>(std::floor(p.x));
+            if(count_ == 0 || column != column_){
+                Flush();
+                column_ = column;
+                first_ = min_ = max_ = last_ = p;
+                index_min_ = index_max_ = 0;
+                count_ = 1;
+                return;
+            }
+            if(p.y < min_.y){
+                min_ = p, index_min_ = count_;
+            }
+            if(p.y > max_.y){
+                max_ = p, index_max_ = count_;
+            }
+            last_ = p;
+            ++count_;
+        }
+        void Flush(){
+            if(count_ == 0){
+                return;
+            }
+            Emit(first_);
+            if(index_min_ < index_max_){
+                Emit(min_), Emit(max_);
+            }
+            else{
+                Emit(max_), Emit(min_);
+            }
+            Emit(last_);
+            count_ = 0;
+        }
+        ~Decimator(){Flush();}
+    };
+};
@@ -0,0 +1,161 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <vector>
+#include "pool.h"
+#include "project.h"
+namespace Chartify{
+    // 256-entry color lookup table interpolated linearly between evenly spaced stops.
+    class Colormap{
+        std::array<sf::Color, 256> lut_;
+    public:
+        Colormap(std::initializer_list<sf::Color> stops){
+            if(stops.size() < 2){
+                throw std::invalid_argument("Colormap needs at least 2 stops!");
+            }
+            const sf::Color* s = stops.begin();
+            const std::size_t last = stops.size() - 1;
+            for(std::size_t k = 0; k < lut_.size(); ++k){
+                float t = k / 255.0f * last;
+                std::size_t j = std::min(last - 1, static_cast<std::size_t>(t));
+                float f = t - j;
+                auto mix = [&](sf::Uint8 a, sf::Uint8 b){return static_cast<sf::Uint8>(std::lround(a + (b - a) * f));};
+                lut_[k] = sf::Color(mix(s[j].r, s[j + 1].r), mix(s[j].g, s[j + 1].g), mix(s[j].b, s[j + 1].b), mix(s[j].a, s[j + 1].a));
+            }
+        }
+        // t in [0, 1].
+        const sf::Color& operator()(float t) const {return lut_[static_cast<std::size_t>(std::min(1.0f, std::max(0.0f, t)) * 255)];}
+        static const Colormap& Viridis(){
+            static const Colormap map{{68, 1, 84}, {72, 40, 120}, {62, 74, 137}, {49, 104, 142}, {38, 130, 142}, {31, 158, 137}, {53, 183, 121}, {109, 205, 89}, {180, 222, 44}, {253, 231, 37}};
+            return map;
+        }
+        static const Colormap& Magma(){
+            static const Colormap map{{0, 0, 4}, {28, 16, 68}, {79, 18, 123}, {129, 37, 129}, {181, 54, 122}, {229, 80, 100}, {251, 135, 97}, {254, 194, 135}, {252, 253, 191}};
+            return map;
+        }
+        static const Colormap& Gray(){
+            static const Colormap map{{230, 230, 230}, {0, 0, 0}};
+            return map;
+        }
+    };
+    // Per-pixel point counts over a plot area, colored through a Colormap into one texture that is
+    // drawn with a single quad. Large inputs are binned on a thread pool: every worker fills its
+    // own partial grid and the grids are summed row-parallel at the end, so Add costs
+    // O(N / workers + pixels) and the grids are reused between frames. Empty pixels stay
+    // transparent; counts are shown on a log scale relative to the densest pixel.
+    class Density : public sf::Drawable{
+        static constexpr std::size_t min_chunk = 1 << 16;
+        ThreadPool* pool_;
+        sf::FloatRect area_;
+        unsigned int width_ = 0, height_ = 0;
+        std::uint32_t max_ = 0;
+        std::vector<std::uint32_t> counts_;
+        std::vector<std::vector<std::uint32_t>> partial_;
+        std::vector<char> used_;
+        std::vector<sf::Uint8> pixels_;
+        sf::Texture texture_;
+        sf::Vertex quad_[4];
+        template<class X, class Y>
+        void Bin(const X* px, const Y* py, std::size_t n, const Affine& affine, std::uint32_t* grid) const {
+            const double left = area_.left, top = area_.top, w = width_, h = height_;
+            for(std::size_t i = 0; i < n; ++i){
+                double x = affine.ox + affine.sx * px[i] - left, y = affine.oy + affine.sy * py[i] - top;
+                if(x >= 0 && y >= 0 && x < w && y < h){
+                    ++grid[static_cast<std::size_t>(y) * width_ + static_cast<std::size_t>(x)];
+                }
+            }
+        }
+        void draw(sf::RenderTarget& target, sf::RenderStates states) const override {
+            if(max_ > 0){
+                states.texture = &texture_;
+                target.draw(quad_, 4, sf::TriangleStrip, states);
+            }
+        }
+    public:
+        explicit Density(ThreadPool& pool = ThreadPool::Shared()) : pool_(&pool){}
+        // Clears the counts and covers area, one cell per whole pixel.
+        void Reset(const sf::FloatRect& area){
+            area_ = area;
+            width_ = static_cast<unsigned int>(std::max(0.0f, area.width)), height_ = static_cast<unsigned int>(std::max(0.0f, area.height));
+            counts_.assign(static_cast<std::size_t>(width_) * height_, 0);
+            max_ = 0;
+        }
+        // Bins points through the same data-to-pixel transform the line series are projected with.
+        template<class X, class Y>
+        void Add(const X* px, const Y* py, std::size_t n, const Affine& affine){
+            if(counts_.empty() || n == 0){
+                return;
+            }
+            if(n < 2 * min_chunk || pool_->Size() == 1){
+                Bin(px, py, n, affine, counts_.data());
+                return;
+            }
+            const std::size_t cells = counts_.size();
+            partial_.resize(pool_->Size());
+            used_.assign(pool_->Size(), 0);
+            const std::size_t chunks = std::min(4 * pool_->Size(), n / min_chunk), step = (n + chunks - 1) / chunks;
+            pool_->For(chunks, [&](std::size_t c, std::size_t worker){
+                std::vector<std::uint32_t>& grid = partial_[worker];
+                if(!used_[worker]){
+                    grid.assign(cells, 0);
+                    used_[worker] = 1;
+                }
+                std::size_t from = c * step, to = std::min(n, from + step);
+                Bin(px + from, py + from, to - from, affine, grid.data());
+            });
+            pool_->For(height_, [&](std::size_t row, std::size_t){
+                std::uint32_t* out = counts_.data() + row * width_;
+                for(std::size_t w = 0; w < partial_.size(); ++w){
+                    if(used_[w]){
+                        const std::uint32_t* in = partial_[w].data() + row * width_;
+                        for(unsigned int x = 0; x < width_; ++x){
+                            out[x] += in[x];
+                        }
+                    }
+                }
+            });
+        }
+        // Colors the counts into the texture; call after the last Add of a frame.
+        void Paint(const Colormap& map){
+            max_ = counts_.empty() ? 0 : *std::max_element(counts_.begin(), counts_.end());
+            if(max_ == 0){
+                return;
+            }
+            pixels_.resize(counts_.size() * 4);
+            const float scale = 1 / std::log1p(static_cast<float>(max_));
+            pool_->For(height_, [&](std::size_t row, std::size_t){
+                const std::uint32_t* in = counts_.data() + row * width_;
+                sf::Uint8* out = pixels_.data() + row * width_ * 4;
+                for(unsigned int x = 0; x < width_; ++x, out += 4){
+                    if(in[x] == 0){
+                        out[0] = out[1] = out[2] = out[3] = 0;
+                        continue;
+                    }
+                    const sf::Color& c = map(std::log1p(static_cast<float>(in[x])) * scale);
+                    out[0] = c.r, out[1] = c.g, out[2] = c.b, out[3] = c.a;
+                }
+            });
+            if(texture_.getSize() != sf::Vector2u(width_, height_)){
+                texture_.create(width_, height_);
+            }
+            texture_.update(pixels_.data());
+            const float l = area_.left, t = area_.top, r = l + width_, b = t + height_;
+            quad_[0] = sf::Vertex(sf::Vector2f(l, t), sf::Vector2f(0, 0));
+            quad_[1] = sf::Vertex(sf::Vector2f(r, t), sf::Vector2f(static_cast<float>(width_), 0));
+            quad_[2] = sf::Vertex(sf::Vector2f(l, b), sf::Vector2f(0, static_cast<float>(height_)));
+            quad_[3] = sf::Vertex(sf::Vector2f(r, b), sf::Vector2f(static_cast<float>(width_), static_cast<float>(height_)));
+        }
+        std::uint32_t Max() const {return max_;}
+        std::uint32_t Count(unsigned int x, unsigned int y) const {return counts_[static_cast<std::size_t>(y) * width_ + x];}
+        sf::Vector2u Size() const {return sf::Vector2u(width_, height_);}
+        // The painted colors, row by row, and the quad they are drawn on; for CPU rendering.
+        const sf::Uint8* Pixels() const {return pixels_.data();}
+        const sf::Vertex* Quad() const {return quad_;}
+    };
+};
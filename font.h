@@ -0,0 +1,133 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+namespace Chartify{
+    // Process-wide font registry. A font file is read from disk once per process and its bytes
+    // are shared; each thread gets one sf::Font over those bytes, because sf::Font fills its
+    // glyph pages lazily and is not safe to use from several threads at once. Missing files are
+    // remembered too, so a failed lookup is not retried every frame.
+    class Fonts{
+        typedef std::shared_ptr<const std::vector<char>> Bytes;
+        static Bytes Read(const std::string& path){
+            static std::mutex mutex;
+            static std::map<std::string, Bytes> files;
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = files.find(path);
+            if(it != files.end()){
+                return it->second;
+            }
+            Bytes bytes;
+            std::ifstream file(path, std::ios::binary);
+            if(file){
+                bytes = std::make_shared<const std::vector<char>>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            }
+            files.emplace(path, bytes);
+            return bytes;
+        }
+    public:
+        // The calling thread's font for path, or nullptr if it can't be loaded. The pointer
+        // stays valid for the lifetime of the thread.
+        static const sf::Font* Find(const std::string& path = "Font/font.ttf"){
+            thread_local std::map<std::string, std::pair<Bytes, std::unique_ptr<sf::Font>>> fonts;
+            auto it = fonts.find(path);
+            if(it == fonts.end()){
+                Bytes bytes = Read(path);
+                std::unique_ptr<sf::Font> font;
+                if(bytes && !bytes->empty()){
+                    font = std::make_unique<sf::Font>();
+                    if(!font->loadFromMemory(bytes->data(), bytes->size())){
+                        font.reset();
+                    }
+                }
+                it = fonts.emplace(path, std::make_pair(bytes, std::move(font))).first;
+            }
+            return it->second.second.get();
+        }
+        static const sf::Font& Load(const std::string& path = "Font/font.ttf"){
+            const sf::Font* font = Find(path);
+            if(!font){
+                throw std::runtime_error("Failed to load font " + path);
+            }
+            return *font;
+        }
+    };
+    // Text laid out once into a single textured vertex array: every string added is drawn with
+    // one draw call, and rebuilding reuses the array's storage instead of allocating sf::Text
+    // objects. Glyph texture coordinates are in pixels, so they stay valid when the font grows
+    // its glyph page.
+    class Glyphs : public sf::Drawable{
+        const sf::Font* font_ = nullptr;
+        unsigned int size_ = 0;
+        sf::VertexArray vertices_;
+        template<class It>
+        sf::Vector2f Layout(It begin, It end, sf::Vector2f position, const sf::Color& color, bool emit){
+            const float spacing = font_->getLineSpacing(size_);
+            float x = position.x, y = position.y + size_, width = 0, height = static_cast<float>(size_);
+            sf::Uint32 prev = 0;
+            for(It it = begin; it != end; ++it){
+                sf::Uint32 c = static_cast<sf::Uint32>(*it);
+                if(c == '\n'){
+                    width = std::max(width, x - position.x);
+                    x = position.x, y += spacing, height += spacing, prev = 0;
+                    continue;
+                }
+                x += font_->getKerning(prev, c, size_);
+                prev = c;
+                const sf::Glyph& glyph = font_->getGlyph(c, size_, false);
+                if(emit && glyph.bounds.width > 0){
+                    float l = x + glyph.bounds.left, t = y + glyph.bounds.top, r = l + glyph.bounds.width, b = t + glyph.bounds.height;
+                    float u0 = static_cast<float>(glyph.textureRect.left), v0 = static_cast<float>(glyph.textureRect.top);
+                    float u1 = u0 + glyph.textureRect.width, v1 = v0 + glyph.textureRect.height;
+                    vertices_.append(sf::Vertex(sf::Vector2f(l, t), color, sf::Vector2f(u0, v0)));
+                    vertices_.append(sf::Vertex(sf::Vector2f(r, t), color, sf::Vector2f(u1, v0)));
+                    vertices_.append(sf::Vertex(sf::Vector2f(l, b), color, sf::Vector2f(u0, v1)));
+                    vertices_.append(sf::Vertex(sf::Vector2f(l, b), color, sf::Vector2f(u0, v1)));
+                    vertices_.append(sf::Vertex(sf::Vector2f(r, t), color, sf::Vector2f(u1, v0)));
+                    vertices_.append(sf::Vertex(sf::Vector2f(r, b), color, sf::Vector2f(u1, v1)));
+                }
+                x += glyph.advance;
+            }
+            return sf::Vector2f(std::max(width, x - position.x), height);
+        }
+        void draw(sf::RenderTarget& target, sf::RenderStates states) const override {
+            if(font_ && vertices_.getVertexCount() > 0){
+                states.texture = &font_->getTexture(size_);
+                target.draw(vertices_, states);
+            }
+        }
+    public:
+        Glyphs() : vertices_(sf::Triangles){}
+        // Drops the laid-out text and sets the font and size for what is added next.
+        void Reset(const sf::Font* font, unsigned int size){
+            font_ = font, size_ = size;
+            vertices_.clear();
+        }
+        bool Ready() const {return font_ != nullptr;}
+        std::size_t Vertices() const {return vertices_.getVertexCount();}
+        // The laid-out quads and the glyph page their texture coordinates refer to; for CPU rendering.
+        const sf::VertexArray& Geometry() const {return vertices_;}
+        const sf::Texture* Page() const {return font_ ? &font_->getTexture(size_) : nullptr;}
+        sf::Vector2f Measure(const char* text){
+            return font_ ? Layout(reinterpret_cast<const unsigned char*>(text), reinterpret_cast<const unsigned char*>(text) + std::char_traits<char>::length(text), sf::Vector2f(), sf::Color(), false) : sf::Vector2f();
+        }
+        sf::Vector2f Measure(const sf::String& text){
+            return font_ ? Layout(text.begin(), text.end(), sf::Vector2f(), sf::Color(), false) : sf::Vector2f();
+        }
+        // Lays out text with its top-left corner at position and returns its size.
+        sf::Vector2f Add(const char* text, sf::Vector2f position, const sf::Color& color){
+            return font_ ? Layout(reinterpret_cast<const unsigned char*>(text), reinterpret_cast<const unsigned char*>(text) + std::char_traits<char>::length(text), position, color, true) : sf::Vector2f();
+        }
+        sf::Vector2f Add(const sf::String& text, sf::Vector2f position, const sf::Color& color){
+            return font_ ? Layout(text.begin(), text.end(), position, color, true) : sf::Vector2f();
+        }
+    };
+};
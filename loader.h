@@ -0,0 +1,207 @@
+#pragma once
+#include "series.h"
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+namespace Chartify{
+    // Read-only memory mapping of a whole file; pages are loaded by the OS on first touch.
+    class Mapping{
+        const void* data_ = nullptr;
+        std::size_t size_ = 0;
+#if defined(_WIN32)
+        HANDLE file_ = INVALID_HANDLE_VALUE, map_ = nullptr;
+#endif
+    public:
+        explicit Mapping(const std::string& path){
+#if defined(_WIN32)
+            file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            LARGE_INTEGER size;
+            if(file_ == INVALID_HANDLE_VALUE || !GetFileSizeEx(file_, &size)){
+                if(file_ != INVALID_HANDLE_VALUE){
+                    CloseHandle(file_);
+                }
+                throw std::runtime_error("Failed to open " + path);
+            }
+            size_ = static_cast<std::size_t>(size.QuadPart);
+            if(size_ > 0){
+                map_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                data_ = map_ ? MapViewOfFile(map_, FILE_MAP_READ, 0, 0, 0) : nullptr;
+                if(!data_){
+                    if(map_){
+                        CloseHandle(map_);
+                    }
+                    CloseHandle(file_);
+                    throw std::runtime_error("Failed to map " + path);
+                }
+            }
+#else
+            int fd = ::open(path.c_str(), O_RDONLY);
+            struct stat st;
+            if(fd < 0 || ::fstat(fd, &st) != 0){
+                if(fd >= 0){
+                    ::close(fd);
+                }
+                throw std::runtime_error("Failed to open " + path);
+            }
+            size_ = static_cast<std::size_t>(st.st_size);
+            if(size_ > 0){
+                void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                if(data == MAP_FAILED){
+                    ::close(fd);
+                    throw std::runtime_error("Failed to map " + path);
+                }
+                ::madvise(data, size_, MADV_SEQUENTIAL);
+                data_ = data;
+            }
+            ::close(fd);
+#endif
+        }
+        Mapping(const Mapping&) = delete;
+        Mapping& operator=(const Mapping&) = delete;
+        const void* Data() const {return data_;}
+        std::size_t Size() const {return size_;}
+        ~Mapping(){
+#if defined(_WIN32)
+            if(data_){
+                UnmapViewOfFile(data_);
+            }
+            if(map_){
+                CloseHandle(map_);
+            }
+            if(file_ != INVALID_HANDLE_VALUE){
+                CloseHandle(file_);
+            }
+#else
+            if(data_){
+                ::munmap(const_cast<void*>(data_), size_);
+            }
+#endif
+        }
+    };
+    class Loader{
+        static bool LittleEndian(){
+            const std::uint16_t one = 1;
+            unsigned char first;
+            std::memcpy(&first, &one, 1);
+            return first == 1;
+        }
+        static bool Separator(char c){return c == ',' || c == ';' || c == ' ' || c == '\t';}
+        // Parses the wanted fields of one line; false if any of them is missing or not a number.
+        static bool Line(const char* p, const char* end, std::size_t xcol, std::size_t ycol, double& x, double& y){
+            std::size_t field = 0, found = 0, last = std::max(xcol, ycol);
+            while(p < end && field <= last){
+                while(p < end && (*p == ' ' || *p == '\t')){
+                    ++p;
+                }
+                const char* q = p;
+                while(q < end && !Separator(*q)){
+                    ++q;
+                }
+                if(field == xcol || field == ycol){
+                    double v;
+                    auto r = std::from_chars(p, q, v);
+                    if(r.ec != std::errc() || r.ptr != q){
+                        return false;
+                    }
+                    if(field == xcol){x = v, ++found;}
+                    if(field == ycol){y = v, ++found;}
+                }
+                p = q < end ? q + 1 : q;
+                ++field;
+            }
+            return found == (xcol == ycol ? 1u : 2u);
+        }
+    public:
+        // Maps a raw little-endian float64/float32 column file without copying it. The
+        // returned column keeps the mapping alive for as long as any copy of it exists.
+        static Column Map(const std::string& path, Precision::Type precision, std::size_t offset = 0){
+            if(!LittleEndian()){
+                throw std::runtime_error("Raw column files are little-endian only!");
+            }
+            auto mapping = std::make_shared<Mapping>(path);
+            std::size_t width = precision == Precision::Single ? sizeof(float) : sizeof(double);
+            if(offset > mapping->Size() || (mapping->Size() - offset) % width != 0){
+                throw std::invalid_argument("File size doesn't match column type: " + path);
+            }
+            const char* data = static_cast<const char*>(mapping->Data()) + offset;
+            std::size_t size = (mapping->Size() - offset) / width;
+            return Column::View(data, size, precision, std::move(mapping));
+        }
+        // Reads a delimited text file in fixed-size chunks and hands parsed (x, y) pairs to
+        // sink(x, y, n) in batches; memory stays bounded by the chunk size. Lines whose wanted
+        // fields are not numbers (headers, comments) are skipped. Returns the number of points.
+        template<class Sink>
+        static std::size_t Stream(const std::string& path, std::size_t xcol, std::size_t ycol, Sink&& sink, std::size_t chunk = 1 << 20){
+            std::unique_ptr<std::FILE, int(*)(std::FILE*)> file(std::fopen(path.c_str(), "rb"), &std::fclose);
+            if(!file){
+                throw std::runtime_error("Failed to open " + path);
+            }
+            std::vector<char> buffer(chunk);
+            std::vector<double> x, y;
+            x.reserve(chunk / 8), y.reserve(chunk / 8);
+            std::size_t kept = 0, total = 0;
+            bool eof = false;
+            while(!eof){
+                std::size_t got = std::fread(buffer.data() + kept, 1, buffer.size() - kept, file.get());
+                eof = got < buffer.size() - kept;
+                const char* p = buffer.data();
+                const char* end = buffer.data() + kept + got;
+                while(p < end){
+                    const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+                    if(!nl && !eof){
+                        break;
+                    }
+                    const char* stop = nl ? nl : end;
+                    const char* line_end = stop > p && stop[-1] == '\r' ? stop - 1 : stop;
+                    double u = 0, v = 0;
+                    if(Line(p, line_end, xcol, ycol, u, v)){
+                        x.push_back(u), y.push_back(xcol == ycol ? u : v);
+                    }
+                    p = nl ? nl + 1 : end;
+                }
+                kept = end - p;
+                std::memmove(buffer.data(), p, kept);
+                if(kept == buffer.size()){
+                    buffer.resize(buffer.size() * 2);
+                }
+                if(!x.empty()){
+                    sink(x.data(), y.data(), x.size());
+                    total += x.size();
+                    x.clear(), y.clear();
+                }
+            }
+            return total;
+        }
+        // Loads two columns of a delimited text file into owned columns.
+        static std::pair<Column, Column> Csv(const std::string& path, std::size_t xcol = 0, std::size_t ycol = 1, Precision::Type precision = Precision::Double){
+            std::vector<double> dx, dy;
+            std::vector<float> fx, fy;
+            Stream(path, xcol, ycol, [&](const double* x, const double* y, std::size_t n){
+                if(precision == Precision::Single){
+                    fx.insert(fx.end(), x, x + n), fy.insert(fy.end(), y, y + n);
+                }
+                else{
+                    dx.insert(dx.end(), x, x + n), dy.insert(dy.end(), y, y + n);
+                }
+            });
+            if(precision == Precision::Single){
+                return std::make_pair(Column(std::move(fx)), Column(std::move(fy)));
+            }
+            return std::make_pair(Column(std::move(dx)), Column(std::move(dy)));
+        }
+    };
+};
@@ -0,0 +1,101 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+namespace Chartify{
+    struct Marker{
+        enum Shape{
+            Point, Square, Circle, Cross
+        };
+    };
+    // Streaming scatter geometry: every pushed point inside the clip rect gets a copy of the
+    // marker's triangle template, all in one sf::Triangles vertex array. Points landing on a
+    // pixel that already has a marker are dropped, so a dense cloud costs O(plot area) vertices
+    // however many points it has. The pixel bitmap is kept between frames.
+    class Scatter{
+        static constexpr std::size_t max_template = 24;
+        sf::Vector2f template_[max_template];
+        std::size_t count_ = 0;
+        sf::VertexArray* out_ = nullptr;
+        sf::Color color_;
+        sf::FloatRect clip_;
+        std::size_t width_ = 0, height_ = 0;
+        std::vector<std::uint64_t> seen_;
+        void Quad(float l, float t, float r, float b){
+            const sf::Vector2f q[] = {{l, t}, {r, t}, {l, b}, {l, b}, {r, t}, {r, b}};
+            std::copy(q, q + 6, template_ + count_);
+            count_ += 6;
+        }
+        void Shape(Marker::Shape shape, float size){
+            const float h = size / 2;
+            count_ = 0;
+            switch(shape){
+                case Marker::Point: Quad(-0.5f, -0.5f, 0.5f, 0.5f);
+                break;
+                case Marker::Square: Quad(-h, -h, h, h);
+                break;
+                case Marker::Circle:
+                    for(int k = 0; k < 8; ++k){
+                        const float a0 = k * 0.785398163f, a1 = (k + 1) * 0.785398163f;
+                        template_[count_++] = sf::Vector2f(0, 0);
+                        template_[count_++] = sf::Vector2f(h * std::cos(a0), h * std::sin(a0));
+                        template_[count_++] = sf::Vector2f(h * std::cos(a1), h * std::sin(a1));
+                    }
+                break;
+                case Marker::Cross:{
+                    const float w = std::max(0.5f, size / 8);
+                    Quad(-h, -w, h, w);
+                    Quad(-w, -h, w, h);
+                }
+                break;
+            }
+        }
+    public:
+        // Forgets the covered pixels; only points inside clip are kept from now on.
+        void Reset(const sf::FloatRect& clip){
+            clip_ = clip;
+            width_ = static_cast<std::size_t>(std::max(0.0f, std::ceil(clip.width))) + 1;
+            height_ = static_cast<std::size_t>(std::max(0.0f, std::ceil(clip.height))) + 1;
+            seen_.assign((width_ * height_ + 63) / 64, 0);
+        }
+        // True if p is inside the clip rect and its pixel has no marker yet; marks the pixel.
+        bool Keep(const sf::Vector2f& p){
+            const float x = p.x - clip_.left, y = p.y - clip_.top;
+            if(!(x >= 0 && y >= 0 && x <= clip_.width && y <= clip_.height)){
+                return false;
+            }
+            const std::size_t pixel = static_cast<std::size_t>(y) * width_ + static_cast<std::size_t>(x);
+            const std::uint64_t bit = std::uint64_t(1) << (pixel & 63);
+            if(seen_[pixel >> 6] & bit){
+                return false;
+            }
+            seen_[pixel >> 6] |= bit;
+            return true;
+        }
+        // Starts a series: markers of shape and size (in pixels) are appended to out, and
+        // only centres inside clip are kept.
+        void Begin(sf::VertexArray& out, const sf::FloatRect& clip, Marker::Shape shape, float size, const sf::Color& color){
+            out.setPrimitiveType(sf::Triangles);
+            out_ = &out, color_ = color;
+            Shape(shape, size);
+            Reset(clip);
+        }
+        void Push(const sf::Vector2f& p){
+            if(!Keep(p)){
+                return;
+            }
+            const sf::Vector2f centre(std::floor(p.x) + 0.5f, std::floor(p.y) + 0.5f);
+            for(std::size_t k = 0; k < count_; ++k){
+                out_->append(sf::Vertex(centre + template_[k], color_));
+            }
+        }
+        void Push(const sf::Vertex* c, std::size_t n){
+            for(std::size_t i = 0; i < n; ++i){
+                Push(c[i].position);
+            }
+        }
+    };
+};
@@ -1,9 +1,27 @@
 #pragma once
 #include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cstdio>
 #include <memory>
 #include <vector>
 #include <iterator>
 #include <cmath>
+#include <fstream>
+#include <string>
+#include <thread>
+#include "stroke.h"
+#include "decimate.h"
+#include "marker.h"
+#include "density.h"
+#include "queue.h"
+#include "vector.h"
+#include "adaptive.h"
+#include "raster.h"
+#include "pyramid.h"
+#include "series.h"
+#include "project.h"
+#include "stats.h"
+#include "font.h"
 namespace matplotlib{
     struct Screen{
         enum Size{
@@ -12,7 +30,14 @@ namespace matplotlib{
     };
     struct Flag{
         enum Style{
-            Solid = 1 << 0, Dashed = 1 << 1, Dotted = 1 << 2
+            Solid = 1 << 0, Dashed = 1 << 1, Dotted = 1 << 2, Decimate = 1 << 3, Line = Solid | Dashed | Dotted,
+            Point = 1 << 4, Square = 1 << 5, Circle = 1 << 6, Cross = 1 << 7, Marker = Point | Square | Circle | Cross,
+            Density = 1 << 8
+        };
+    };
+    struct Dirty{
+        enum Part{
+            Data = 1 << 0, Title = 1 << 1, Size = 1 << 2, Style = 1 << 3, Frame = 1 << 4, View = 1 << 5, All = Data | Title | Size | Style | Frame | View
         };
     };
     class Color{
@@ -44,6 +69,10 @@ namespace matplotlib{
         static Color White(){return Color({255, 255, 255}, 255);}
         static Color Black(){return Color({0, 0, 0}, 255);}
         static Color Blue(){return Color({0, 0, 255}, 255);}
+        static Color Red(){return Color({255, 0, 0}, 255);}
+        static Color Green(){return Color({0, 255, 0}, 255);}
+        static Color Orange(){return Color({255, 165, 0}, 255);}
+        static Color Violet(){return Color({148, 0, 211}, 255);}
         const sf::Color& Data() const {return color_;}
         const uint8_t& Alpha() const {return alpha_;}
         virtual ~Color() = default;
@@ -60,18 +89,95 @@ namespace matplotlib{
         }
         const Color& Data() const {return color_;}
     };
+    struct Mode{
+        enum Type{
+            Window, Headless
+        };
+    };
+    // Gpu draws through SFML; Raster draws on the CPU with Chartify::Raster, in parallel tiles,
+    // and shows the frame as one texture.
+    struct Backend{
+        enum Type{
+            Gpu, Raster
+        };
+    };
     class RenderProfile{
         sf::String title_;
         sf::Vector2u sizes_;
-        sf::RenderWindow profile_;
+        Mode::Type mode_;
+        Backend::Type backend_;
+        std::unique_ptr<sf::RenderWindow> window_;
+        std::unique_ptr<sf::RenderTexture> texture_;
+        std::size_t draws_ = 0, vertices_ = 0;
+        std::unique_ptr<Chartify::Raster> raster_;
+        sf::View view_;
+        sf::Texture frame_;
+        // Bitmaps of the textured draws since the last Clear, one per source. Font glyph pages
+        // are copied to the CPU by Display, after every draw of the frame has laid out its text,
+        // so glyphs added to a page late in the frame still show up.
+        struct Page{
+            const void* source;
+            const sf::Texture* texture;
+            sf::Image image;
+            Chartify::Bitmap bitmap;
+            bool used;
+        };
+        std::vector<std::unique_ptr<Page>> pages_;
+        void Offscreen(){
+            if(raster_){
+                raster_->Resize(sizes_.x, sizes_.y);
+                view_.reset(sf::FloatRect(0, 0, static_cast<float>(sizes_.x), static_cast<float>(sizes_.y)));
+                if(window_ && !frame_.create(sizes_.x, sizes_.y)){
+                    throw std::runtime_error("Failed to create frame texture!");
+                }
+                return;
+            }
+            texture_ = std::make_unique<sf::RenderTexture>();
+            if(!texture_->create(sizes_.x, sizes_.y)){
+                throw std::runtime_error("Failed to create offscreen target!");
+            }
+        }
+        // Maps the current view to target pixels the way SFML does; views are never rotated here.
+        Chartify::Affine Map(sf::IntRect& port) const {
+            const sf::FloatRect& v = view_.getViewport();
+            port = sf::IntRect(static_cast<int>(0.5f + sizes_.x * v.left), static_cast<int>(0.5f + sizes_.y * v.top), static_cast<int>(0.5f + sizes_.x * v.width), static_cast<int>(0.5f + sizes_.y * v.height));
+            const sf::Vector2f& c = view_.getCenter();
+            const sf::Vector2f& s = view_.getSize();
+            double sx = port.width / s.x, sy = port.height / s.y;
+            return Chartify::Affine{port.left - (c.x - s.x / 2) * sx, sx, port.top - (c.y - s.y / 2) * sy, sy};
+        }
+        void Record(const sf::Vertex* vertices, std::size_t n, sf::PrimitiveType type, const Chartify::Bitmap* bitmap = nullptr){
+            sf::IntRect port;
+            const Chartify::Affine affine = Map(port);
+            raster_->Draw(vertices, n, type, affine, port, bitmap);
+            ++draws_, vertices_ += n;
+        }
+        Page& Pixels(const void* source){
+            auto it = std::find_if(pages_.begin(), pages_.end(), [&](const std::unique_ptr<Page>& page){return page->source == source;});
+            if(it == pages_.end()){
+                pages_.push_back(std::make_unique<Page>(Page{source, nullptr, sf::Image(), Chartify::Bitmap{nullptr, 0, 0}, false}));
+                it = pages_.end() - 1;
+            }
+            (*it)->used = true;
+            return **it;
+        }
     public:
-        RenderProfile(unsigned int width, unsigned int height, const sf::String& title) : title_(title), sizes_(width, height), profile_(sf::VideoMode(sizes_.x, sizes_.y), title_){
+        RenderProfile(unsigned int width, unsigned int height, const sf::String& title, Mode::Type mode = Mode::Window, Backend::Type backend = Backend::Gpu) : title_(title), sizes_(width, height), mode_(mode), backend_(backend){
             if(title_.isEmpty()){
                 throw std::invalid_argument("Title is absented!");
             }
             if(sizes_.x == 0 || sizes_.y == 0){
                 throw std::invalid_argument("Invalid sizes for profile!");
             }
+            if(mode_ == Mode::Window){
+                window_ = std::make_unique<sf::RenderWindow>(sf::VideoMode(sizes_.x, sizes_.y), title_);
+            }
+            if(backend_ == Backend::Raster){
+                raster_ = std::make_unique<Chartify::Raster>();
+            }
+            if(mode_ == Mode::Headless || raster_){
+                Offscreen();
+            }
         }
         RenderProfile(const RenderProfile&) = delete;
         RenderProfile& operator=(const RenderProfile&) = delete;
@@ -79,212 +185,1115 @@ namespace matplotlib{
         RenderProfile& operator=(RenderProfile&&) = default;
         const sf::String& Title() const {return title_;}
         const sf::Vector2u& Data() const {return sizes_;}
-        sf::RenderWindow& Profile(){return profile_;}
+        bool Headless() const {return mode_ == Mode::Headless;}
+        bool Rasterized() const {return backend_ == Backend::Raster;}
+        void Resize(unsigned int width, unsigned int height){
+            if(width == 0 || height == 0){
+                throw std::invalid_argument("Invalid sizes for profile!");
+            }
+            sizes_ = sf::Vector2u(width, height);
+            if(Headless() || raster_){
+                Offscreen();
+            }
+        }
+        sf::RenderTarget& Target(){
+            if(raster_){
+                throw std::logic_error("Raster profile draws without a render target!");
+            }
+            if(Headless()){
+                return *texture_;
+            }
+            return *window_;
+        }
+        void View(const sf::View& view){
+            if(raster_){
+                view_ = view;
+            }
+            else{
+                Target().setView(view);
+            }
+        }
+        void Clear(const sf::Color& color){
+            if(raster_){
+                raster_->Clear(color);
+                for(auto& page : pages_){
+                    page->used = false;
+                }
+            }
+            else{
+                Target().clear(color);
+            }
+            draws_ = vertices_ = 0;
+        }
+        void Draw(const sf::Drawable& drawable){
+            if(raster_){
+                throw std::logic_error("Raster profile draws vertex arrays, glyphs and density maps only!");
+            }
+            Target().draw(drawable);
+            ++draws_;
+        }
+        void Draw(const sf::VertexArray& vertices){
+            if(raster_){
+                if(vertices.getVertexCount() > 0){
+                    Record(&vertices[0], vertices.getVertexCount(), vertices.getPrimitiveType());
+                }
+                return;
+            }
+            Target().draw(vertices);
+            ++draws_, vertices_ += vertices.getVertexCount();
+        }
+        void Draw(const Chartify::Glyphs& glyphs){
+            if(!raster_){
+                Target().draw(glyphs);
+                ++draws_;
+                return;
+            }
+            const sf::VertexArray& vertices = glyphs.Geometry();
+            if(glyphs.Page() && vertices.getVertexCount() > 0){
+                Page& page = Pixels(glyphs.Page());
+                page.texture = glyphs.Page();
+                Record(&vertices[0], vertices.getVertexCount(), vertices.getPrimitiveType(), &page.bitmap);
+            }
+        }
+        void Draw(const Chartify::Density& density){
+            if(!raster_){
+                Target().draw(density);
+                ++draws_;
+                return;
+            }
+            if(density.Max() > 0){
+                Page& page = Pixels(&density);
+                page.texture = nullptr;
+                page.bitmap = Chartify::Bitmap{density.Pixels(), density.Size().x, density.Size().y};
+                Record(density.Quad(), 4, sf::TriangleStrip, &page.bitmap);
+            }
+        }
+        std::size_t DrawCalls() const {return draws_;}
+        std::size_t Vertices() const {return vertices_;}
+        sf::RenderWindow& Profile(){
+            if(!window_){
+                throw std::logic_error("Headless profile has no window!");
+            }
+            return *window_;
+        }
+        void Display(){
+            if(raster_){
+                for(auto& page : pages_){
+                    if(page->used && page->texture){
+                        page->image = page->texture->copyToImage();
+                        page->bitmap = Chartify::Bitmap{page->image.getPixelsPtr(), page->image.getSize().x, page->image.getSize().y};
+                    }
+                }
+                raster_->Flush();
+                if(window_){
+                    frame_.update(raster_->Pixels());
+                    window_->setView(sf::View(sf::FloatRect(0, 0, static_cast<float>(sizes_.x), static_cast<float>(sizes_.y))));
+                    window_->draw(sf::Sprite(frame_));
+                    window_->display();
+                }
+            }
+            else if(Headless()){
+                texture_->display();
+            }
+            else{
+                window_->display();
+            }
+        }
+        sf::Image Capture(){
+            sf::Image image;
+            if(raster_){
+                image.create(sizes_.x, sizes_.y, raster_->Pixels());
+                return image;
+            }
+            if(Headless()){
+                return texture_->getTexture().copyToImage();
+            }
+            sf::Texture texture;
+            texture.create(sizes_.x, sizes_.y);
+            texture.update(*window_);
+            return texture.copyToImage();
+        }
         virtual ~RenderProfile() = default;
     };
+    // Writes binary PPM for paths ending in ".ppm" and lets SFML pick the format otherwise.
+    inline void WriteImage(const sf::Image& image, const std::string& path){
+        const std::string ppm = ".ppm";
+        if(path.size() >= ppm.size() && path.compare(path.size() - ppm.size(), ppm.size(), ppm) == 0){
+            std::ofstream file(path, std::ios::binary);
+            file << "P6\n" << image.getSize().x << " " << image.getSize().y << "\n255\n";
+            const sf::Uint8* pixels = image.getPixelsPtr();
+            std::vector<char> row(image.getSize().x * 3);
+            for(unsigned int y = 0; y < image.getSize().y; ++y){
+                for(unsigned int x = 0; x < image.getSize().x; ++x, pixels += 4){
+                    row[x * 3] = pixels[0], row[x * 3 + 1] = pixels[1], row[x * 3 + 2] = pixels[2];
+                }
+                file.write(row.data(), row.size());
+            }
+            if(!file){
+                throw std::runtime_error("Failed to save image!");
+            }
+        }
+        else if(!image.saveToFile(path)){
+            throw std::runtime_error("Failed to save image!");
+        }
+    }
     class Canvas{
-        std::unique_ptr<RenderProfile> profile_;
+        struct Bounds{
+            double x0, x1, y0, y1;
+        };
+        std::shared_ptr<RenderProfile> profile_;
+        // Size of the canvas in pixels and where it sits in the profile's target, as fractions of
+        // the target; a standalone canvas covers all of it.
+        sf::Vector2u size_;
+        sf::FloatRect area_{0, 0, 1, 1};
+        bool panel = false;
+        sf::VertexArray back_;
         Color fone_, grid_, axes_;
-        std::vector<std::vector<double>> x_, y_;
+        std::vector<Chartify::Column> x_, y_;
+        Chartify::Precision::Type precision_ = Chartify::Precision::Double;
         std::vector<Color> color_;
-        sf::Font font_;
+        // Fonts::Find() gives every thread its own font, so the cached one belongs to font_thread_.
+        const sf::Font* font_ = nullptr;
+        std::thread::id font_thread_;
         sf::String title_;
         std::vector<unsigned int> linestyle_;
+        std::vector<Chartify::Stroke::Painter> painter_;
         const float space_ = 70;
         const unsigned int fontsize_ = 18;
         const float extra_space = 20;
+        const float marker_size = 6;
+        const int frame_ms = 16;
         bool title_enabled = false;
-        sf::Text text_;
-        sf::View view_;
-        std::vector<std::pair<std::vector<double>::const_iterator, std::vector<double>::const_iterator>> it_x, it_y;
-        void Solid(const std::vector<sf::Vertex>& c, const Color& color){
-            const float spacing = 0.5;
-            const float R = 1;
-            for(std::size_t i = 1; i < c.size(); ++i){
-                const sf::Vector2f& iu = c[i - 1].position, iv = c[i].position;
-                sf::Vector2f div = iv - iu;
-                float segment_len = std::sqrt(div.x * div.x + div.y * div.y);
-                div /= segment_len;
-                for(float s = 0.0f; s < segment_len; s += spacing){
-                    sf::Vector2f dx = iu + div * s;
-                    sf::CircleShape dot(R);
-                    dot.setPosition(dx);
-                    dot.setFillColor(color.Data());
-                    profile_->Profile().draw(dot);
-                }
-            }
-        }
-        void Dashed(const std::vector<sf::Vertex>& c, const Color& color){
-            const float R = 1;
-            const float dash_len = 10;
-            const float gap_len = 5;
-            for(std::size_t i = 1; i < c.size(); ++i){
-                const sf::Vector2f& iu = c[i - 1].position, iv = c[i].position;
-                sf::Vector2f div = iv - iu;
-                float segment_len = std::sqrt(div.x * div.x + div.y * div.y);
-                div /= segment_len;
-                float drawn = 0;
-                bool dash_drawn = true;
-                while(drawn < segment_len) {
-                    float step = dash_drawn ? dash_len : gap_len;
-                    float current_step = std::min(step, segment_len - drawn);
-                    sf::Vector2f start = iu + div * drawn;
-                    sf::Vector2f end = iu + div * (drawn + current_step);
-                    if(dash_drawn) {
-                        for(float s = 0; s < current_step; s += 0.5) {
-                            sf::Vector2f pos = iu + div * (drawn + s);
-                            sf::CircleShape dot(R);
-                            dot.setPosition(pos.x - R, pos.y - R);
-                            dot.setFillColor(color.Data());
-                            profile_->Profile().draw(dot);
+        bool overlay_enabled = false;
+        bool dragging = false;
+        Chartify::Glyphs text_, overlay_;
+        sf::View view_, clip_;
+        unsigned int dirty_ = Dirty::All;
+        std::vector<bool> stale_, sorted_;
+        std::vector<Bounds> bounds_;
+        // Visible part of every series' data range, as fractions of it; y grows upwards.
+        Bounds zoom_{0, 1, 0, 1};
+        static constexpr double min_zoom = 1e-9;
+        sf::Vector2i drag_;
+        static constexpr std::size_t block_size = 4096;
+        std::vector<sf::Vertex> chart_, block_;
+        std::vector<sf::VertexArray> strokes_;
+        Chartify::Scatter scatter_;
+        Chartify::Simplifier simplifier_;
+        std::vector<sf::Vector2f> centres_;
+        // Vector export keeps lines within this many pixels of the samples.
+        const float export_tolerance = 0.5f;
+        Chartify::Sampler sampler_;
+        // PlotFunction keeps curves within this many pixels of f.
+        const float function_tolerance = 0.5f;
+        // Series with Flag::Density share one count grid; it is rebuilt whenever one of them is.
+        Chartify::Density density_;
+        Chartify::Colormap colormap_ = Chartify::Colormap::Viridis();
+        bool rebin = false;
+        std::vector<std::unique_ptr<Chartify::Ring>> rings_;
+        // Min/max summaries of indexed series; lines of a sorted series are drawn from the level
+        // with about nodes_per_pixel nodes per pixel of plane width while that is coarser than
+        // the raw samples.
+        std::vector<std::shared_ptr<const Chartify::Pyramid>> pyramids_;
+        static constexpr std::size_t nodes_per_pixel = 4;
+        std::unique_ptr<Chartify::Queue<Chartify::Sample>> feed_;
+        std::uint64_t ingested_ = 0;
+        sf::VertexArray grid_lines_, axes_lines_;
+        Chartify::Glyphs labels_;
+        Chartify::Stats stats_;
+        void Grow(std::size_t n){
+            stale_.resize(n, true);
+            sorted_.resize(n, false);
+            bounds_.resize(n);
+            strokes_.resize(n);
+            rings_.resize(n);
+            pyramids_.resize(n);
+        }
+        void Measure(std::size_t i){
+            if(rings_[i]){
+                const Chartify::Ring& ring = *rings_[i];
+                if(ring.Size() == 0){
+                    bounds_[i] = Bounds{0, 1, 0, 1};
+                    return;
+                }
+                double x0 = ring.Window() > 0 ? ring.XMax() - ring.Window() : ring.XMin();
+                bounds_[i] = Bounds{x0, ring.XMax(), ring.YMin(), ring.YMax()};
+                sorted_[i] = false;
+                return;
+            }
+            if(pyramids_[i]){
+                const Chartify::Pyramid& pyramid = *pyramids_[i];
+                bounds_[i] = Bounds{pyramid.XMin(), pyramid.XMax(), pyramid.YMin(), pyramid.YMax()};
+                sorted_[i] = pyramid.Sorted();
+                return;
+            }
+            auto range = [](const Chartify::Column& c){
+                return c.Visit([&](auto p){return Chartify::Kernel::Bounds(p, c.Size());});
+            };
+            auto rx = range(x_[i]), ry = range(y_[i]);
+            bounds_[i] = Bounds{rx.first, rx.second, ry.first, ry.second};
+            sorted_[i] = x_[i].Visit([&](auto p){return std::is_sorted(p, p + x_[i].Size());});
+        }
+        Bounds Visible(std::size_t i) const {
+            const Bounds& b = bounds_[i];
+            double w = b.x1 - b.x0, h = b.y1 - b.y0;
+            return Bounds{b.x0 + zoom_.x0 * w, b.x0 + zoom_.x1 * w, b.y0 + zoom_.y0 * h, b.y0 + zoom_.y1 * h};
+        }
+        // Index range of a sorted series that can reach the visible x range, including the
+        // neighbours just outside it so the lines leaving the plane are still drawn.
+        std::pair<std::size_t, std::size_t> Slice(std::size_t i, double x0, double x1) const {
+            const std::size_t n = x_[i].Size();
+            if(!sorted_[i]){
+                return std::make_pair(std::size_t(0), n);
+            }
+            return x_[i].Visit([&](auto p){
+                std::size_t from = std::lower_bound(p, p + n, x0) - p;
+                std::size_t to = std::upper_bound(p + from, p + n, x1) - p;
+                return std::make_pair(from > 0 ? from - 1 : from, std::min(n, to + 1));
+            });
+        }
+        void Confine(){
+            double w = std::min(1.0, std::max(min_zoom, zoom_.x1 - zoom_.x0)), h = std::min(1.0, std::max(min_zoom, zoom_.y1 - zoom_.y0));
+            double x0 = std::min(1 - w, std::max(0.0, zoom_.x0)), y0 = std::min(1 - h, std::max(0.0, zoom_.y0));
+            zoom_ = Bounds{x0, x0 + w, y0, y0 + h};
+            dirty_ |= Dirty::View;
+        }
+        sf::FloatRect Plane() const {
+            float left = space_ + extra_space, top = space_ + extra_space;
+            return sf::FloatRect(left, top, size_.x - 2 * left, size_.y - 2 * top);
+        }
+        // Calls f(px, py, n) for the runs of series i that can reach the visible range b. With
+        // summaries, an indexed series may be visited as its pyramid nodes instead, which keep
+        // the shape M4 needs but not the individual samples.
+        template<class F>
+        void Walk(std::size_t i, const Bounds& b, F&& f, bool summaries = false){
+            if(rings_[i]){
+                rings_[i]->Segments(f);
+                return;
+            }
+            auto slice = Slice(i, b.x0, b.x1);
+            std::size_t level;
+            const std::size_t nodes = nodes_per_pixel * static_cast<std::size_t>(std::max(1.0f, Plane().width));
+            if(summaries && pyramids_[i] && sorted_[i] && pyramids_[i]->Level((slice.second - slice.first) / nodes, level)){
+                pyramids_[i]->Walk(level, slice.first, slice.second, f);
+                return;
+            }
+            Chartify::Visit(x_[i], y_[i], [&](auto px, auto py){f(px + slice.first, py + slice.first, slice.second - slice.first);});
+        }
+        // Projects what Walk visits through affine, block_size points at a time, and calls
+        // f(vertices, n) for every block.
+        template<class F>
+        void Blocks(std::size_t i, const Bounds& b, const Chartify::Affine& affine, const sf::Color& color, F&& f, bool summaries = false){
+            block_.resize(block_size);
+            Walk(i, b, [&](auto px, auto py, std::size_t n){
+                for(std::size_t k = 0; k < n; k += block_size){
+                    std::size_t m = std::min(block_size, n - k);
+                    Chartify::Kernel::Project(px + k, py + k, m, affine, color, block_.data());
+                    f(block_.data(), m);
+                }
+            }, summaries);
+        }
+        void Build(std::size_t i){
+            if(linestyle_[i] & Flag::Density){
+                strokes_[i].clear();
+                rebin = true;
+                return;
+            }
+            const Bounds b = Visible(i);
+            const Chartify::Affine affine = Chartify::Affine::Fit(b.x0, b.x1, b.y0, b.y1, Plane());
+            const sf::Color& color = color_[i].Data();
+            // Indexed series are always decimated; their summaries stand in for the samples
+            // unless markers need the real points.
+            const bool summaries = pyramids_[i] && !(linestyle_[i] & Flag::Marker);
+            const bool decimate = (linestyle_[i] & Flag::Decimate) || pyramids_[i];
+            // Series with markers but no line never keep their projected points: blocks go
+            // straight into the scatter builder, which culls and collapses them.
+            const bool scatter = (linestyle_[i] & Flag::Marker) && !(linestyle_[i] & Flag::Line);
+            const sf::FloatRect plane = Plane();
+            sf::VertexArray& stroke = strokes_[i];
+            stroke.clear();
+            chart_.clear();
+            if(scatter){
+                scatter_.Begin(stroke, plane, Shape(linestyle_[i]), marker_size, color);
+            }
+            Chartify::Decimator m4(chart_, color);
+            {
+                Chartify::Stats::Scope scope(stats_, Chartify::Stage::Projection);
+                if(!decimate && !scatter){
+                    Walk(i, b, [&](auto px, auto py, std::size_t n){
+                        std::size_t at = chart_.size();
+                        chart_.resize(at + n);
+                        Chartify::Kernel::Project(px, py, n, affine, color, chart_.data() + at);
+                    });
+                }
+                else{
+                    Blocks(i, b, affine, color, [&](const sf::Vertex* v, std::size_t m){
+                        if(scatter){
+                            scatter_.Push(v, m);
+                            return;
                         }
-                    }
-                    drawn += current_step;
-                    dash_drawn = !dash_drawn;
+                        for(std::size_t l = 0; l < m; ++l){
+                            m4.Push(v[l].position);
+                        }
+                    }, summaries);
                 }
+                m4.Flush();
+            }
+            Chartify::Stats::Scope scope(stats_, Chartify::Stage::Stroke);
+            const sf::FloatRect clip(plane.left - 4, plane.top - 4, plane.width + 8, plane.height + 8);
+            if(painter_[i] && !chart_.empty()){
+                // Patterns are anchored to the start of the series, measured along x, so
+                // panning doesn't restart them at the first visible sample.
+                const double phase = chart_[0].position.x - (affine.ox + affine.sx * bounds_[i].x0);
+                painter_[i](chart_.data(), chart_.size(), color, stroke, &clip, phase);
+            }
+            if(!scatter && (linestyle_[i] & Flag::Marker)){
+                scatter_.Begin(stroke, plane, Shape(linestyle_[i]), marker_size, color);
+                scatter_.Push(chart_.data(), chart_.size());
             }
         }
-        void Dotted(const std::vector<sf::Vertex>& c, const Color& color){
-            const float spacing = 7;
-            const float R = 2;
-            for(std::size_t i = 1; i < c.size(); ++i){
-                const sf::Vector2f& iu = c[i - 1].position, iv = c[i].position;
-                sf::Vector2f div = iv - iu;
-                float segment_len = std::sqrt(div.x * div.x + div.y * div.y);
-                div /= segment_len;
-                for(float s = 0.0f; s < segment_len; s += spacing){
-                    sf::Vector2f dx = iu + div * s;
-                    sf::CircleShape dot(R);
-                    dot.setPosition(dx);
-                    dot.setFillColor(color.Data());
-                    profile_->Profile().draw(dot);
+        void Bin(){
+            density_.Reset(Plane());
+            for(std::size_t i = 0; i < x_.size(); ++i){
+                if(!(linestyle_[i] & Flag::Density)){
+                    continue;
                 }
+                const Bounds b = Visible(i);
+                const Chartify::Affine affine = Chartify::Affine::Fit(b.x0, b.x1, b.y0, b.y1, Plane());
+                Walk(i, b, [&](auto px, auto py, std::size_t n){density_.Add(px, py, n, affine);});
             }
+            density_.Paint(colormap_);
+            rebin = false;
         }
         void Grid(){
-            for(int v = space_; v <= profile_->Data().x - space_; v += (profile_->Data().x - 2 * space_)/ 10){
-                sf::Vertex vl[] = {sf::Vertex(sf::Vector2f(v, space_), grid_.Data()), sf::Vertex(sf::Vector2f(v, (profile_->Data().y - space_)), grid_.Data())};
-                profile_->Profile().draw(vl, 2, sf::LineStrip);
-                // float x_value = *it_x[0].first + ((v - space_) / (profile_->Data().x - 2 * space_)) * (*it_x[0].second - *it_x[0].first);
-                // sf::Text x_label(std::to_string(x_value).substr(0, 4), font_, fontsize_ - 4);
-                // x_label.setFillColor(axes_.Data());
-                // x_label.setPosition(v - 10, profile_->Data().y - space_ + 5);
-                // profile_->Profile().draw(x_label);
-            }
-            for(int h = space_; h <= profile_->Data().y - space_; h += (profile_->Data().y - 2 * space_)/ 10){
-                sf::Vertex hl[] = {sf::Vertex(sf::Vector2f(space_, h), grid_.Data()), sf::Vertex(sf::Vector2f(profile_->Data().x - space_, h), grid_.Data())};
-                profile_->Profile().draw(hl, 2, sf::LineStrip);
-                // float y_value = *it_y[0].second - ((h - space_) / (profile_->Data().y - 2 * space_)) * (*it_y[0].second - *it_y[0].first);
-                // sf::Text y_label(std::to_string(y_value).substr(0, 4), font_, fontsize_ - 4);
-                // y_label.setFillColor(axes_.Data());
-                // y_label.setPosition(space_ - 35, h - 10);
-                // profile_->Profile().draw(y_label);
+            grid_lines_.clear();
+            grid_lines_.setPrimitiveType(sf::Lines);
+            for(int v = space_; v <= size_.x - space_; v += (size_.x - 2 * space_)/ 10){
+                grid_lines_.append(sf::Vertex(sf::Vector2f(v, space_), grid_.Data())), grid_lines_.append(sf::Vertex(sf::Vector2f(v, (size_.y - space_)), grid_.Data()));
+            }
+            for(int h = space_; h <= size_.y - space_; h += (size_.y - 2 * space_)/ 10){
+                grid_lines_.append(sf::Vertex(sf::Vector2f(space_, h), grid_.Data())), grid_lines_.append(sf::Vertex(sf::Vector2f(size_.x - space_, h), grid_.Data()));
+            }
+        }
+        // Tick labels of the first series' visible range, placed on the grid lines. They are
+        // rebuilt only with the grid and skipped when no font is available.
+        // Calls f(text, top_left) for every tick label.
+        template<class F>
+        void Ticks(F&& f){
+            const Bounds b = Visible(0);
+            const sf::FloatRect plane = Plane();
+            char value[32];
+            auto label = [&](double v, float x, float y){
+                std::snprintf(value, sizeof(value), "%.4g", v);
+                f(static_cast<const char*>(value), sf::Vector2f(x, y));
+            };
+            for(int v = space_; v <= size_.x - space_; v += (size_.x - 2 * space_)/ 10){
+                label(b.x0 + (v - plane.left) / plane.width * (b.x1 - b.x0), v - 10, size_.y - space_ + 5);
+            }
+            for(int h = space_; h <= size_.y - space_; h += (size_.y - 2 * space_)/ 10){
+                label(b.y1 - (h - plane.top) / plane.height * (b.y1 - b.y0), space_ - 55, h - 10);
+            }
+        }
+        void Labels(){
+            labels_.Reset(TryFont(), fontsize_ - 4);
+            if(x_.empty() || !font_){
+                return;
             }
+            Ticks([&](const char* text, sf::Vector2f at){labels_.Add(text, at, axes_.Data());});
+        }
+        // Strokes are drawn through a view covering only the plot plane, so zoomed lines are
+        // clipped by the GPU instead of on the CPU.
+        void Clip(){
+            const float pad = 2;
+            sf::FloatRect plane = Plane();
+            plane = sf::FloatRect(plane.left - pad, plane.top - pad, plane.width + 2 * pad, plane.height + 2 * pad);
+            clip_.reset(plane);
+            clip_.setViewport(sf::FloatRect(area_.left + plane.left / size_.x * area_.width, area_.top + plane.top / size_.y * area_.height,
+                plane.width / size_.x * area_.width, plane.height / size_.y * area_.height));
         }
         void Axes(){
             int x = space_;
-            int y = profile_->Data().y - space_;
-            sf::Vertex xl[] = {sf::Vertex(sf::Vector2f(space_, y), axes_.Data()), sf::Vertex(sf::Vector2f(profile_->Data().x - space_, y), axes_.Data())};
-            sf::Vertex yl[] = {sf::Vertex(sf::Vector2f(x, space_), axes_.Data()), sf::Vertex(sf::Vector2f(x, profile_->Data().y - space_), axes_.Data())};
-            profile_->Profile().draw(xl, 2, sf::LineStrip), profile_->Profile().draw(yl, 2, sf::LineStrip);
+            int y = size_.y - space_;
+            axes_lines_.clear();
+            axes_lines_.setPrimitiveType(sf::Lines);
+            axes_lines_.append(sf::Vertex(sf::Vector2f(space_, y), axes_.Data())), axes_lines_.append(sf::Vertex(sf::Vector2f(size_.x - space_, y), axes_.Data()));
+            axes_lines_.append(sf::Vertex(sf::Vector2f(x, space_), axes_.Data())), axes_lines_.append(sf::Vertex(sf::Vector2f(x, size_.y - space_), axes_.Data()));
+        }
+        const sf::Font* TryFont(){
+            if(!font_ || font_thread_ != std::this_thread::get_id()){
+                font_ = Chartify::Fonts::Find();
+                font_thread_ = std::this_thread::get_id();
+            }
+            return font_;
         }
-        void InitTitle() {
-            if (!font_.loadFromFile("Font/font.ttf")) {
+        void LoadFont(){
+            if(!TryFont()){
                 throw std::runtime_error("Failed to load font for title");
             }
-            text_.setFont(font_);
-            text_.setCharacterSize(fontsize_);
-            text_.setFillColor(Color::Black().Data());
-            UpdateTitlePosition();
         }
         void UpdateTitlePosition() {
+            text_.Reset(font_, fontsize_);
             if (title_enabled) {
-                sf::FloatRect textBounds = text_.getLocalBounds();
-                text_.setOrigin(textBounds.left + textBounds.width / 2, textBounds.top);
-                text_.setPosition(view_.getCenter().x, space_ / 2);
+                sf::Vector2f extent = text_.Measure(title_);
+                text_.Add(title_, sf::Vector2f(view_.getCenter().x - extent.x / 2, space_ / 2 - fontsize_ / 4), Color::Black().Data());
+            }
+        }
+        void HandleResize(const sf::Event& event) {
+            profile_->Resize(event.size.width, event.size.height);
+            Place(area_);
+        }
+        // Lays the canvas out over area of the profile's target, given as fractions of it.
+        void Place(const sf::FloatRect& area){
+            const sf::Vector2u& target = profile_->Data();
+            area_ = area;
+            size_ = sf::Vector2u(std::max(1u, static_cast<unsigned int>(area.width * target.x + 0.5f)), std::max(1u, static_cast<unsigned int>(area.height * target.y + 0.5f)));
+            view_.reset(sf::FloatRect(0, 0, size_.x, size_.y));
+            view_.setViewport(area_);
+            back_.setPrimitiveType(sf::TriangleStrip);
+            back_.resize(4);
+            back_[0] = sf::Vertex(sf::Vector2f(0, 0), fone_.Data()), back_[1] = sf::Vertex(sf::Vector2f(size_.x, 0), fone_.Data());
+            back_[2] = sf::Vertex(sf::Vector2f(0, size_.y), fone_.Data()), back_[3] = sf::Vertex(sf::Vector2f(size_.x, size_.y), fone_.Data());
+            dirty_ |= Dirty::Size;
+        }
+        bool Pending() const {return dirty_ != 0 || (feed_ && !feed_->Empty());}
+        // Everything a frame needs before drawing: queued samples and dirty geometry.
+        void Prepare(){
+            if(feed_){
+                Chartify::Stats::Scope scope(stats_, Chartify::Stage::Bounds);
+                Ingest();
+            }
+            // Text laid out on another thread refers to that thread's font; lay it out again.
+            const bool moved = font_ && font_thread_ != std::this_thread::get_id();
+            if(moved){
+                TryFont();
+                dirty_ |= Dirty::Title;
+            }
+            Update();
+            if(moved){
+                Labels();
+            }
+        }
+        // Draws the canvas into its area of the target without clearing or presenting it, so
+        // several canvases can share one frame.
+        void Render(){
+            {
+                Chartify::Stats::Scope scope(stats_, Chartify::Stage::Present);
+                profile_->View(view_);
+                if(panel){
+                    profile_->Draw(back_);
+                }
+                profile_->View(clip_);
+                if(density_.Max() > 0){
+                    profile_->Draw(density_);
+                }
+                for(std::size_t i = 0; i < strokes_.size(); ++i){
+                    profile_->Draw(strokes_[i]);
+                }
+                profile_->View(view_);
+                profile_->Draw(grid_lines_);
+                profile_->Draw(axes_lines_);
+            }
+            {
+                Chartify::Stats::Scope scope(stats_, Chartify::Stage::Labels);
+                profile_->Draw(labels_);
             }
+            {
+                Chartify::Stats::Scope scope(stats_, Chartify::Stage::Title);
+                DrawTitle();
+            }
+            Chartify::Stats::Scope scope(stats_, Chartify::Stage::Present);
+            DrawOverlay();
         }
-        void HandleTitleResize(const sf::Event& event) {
-            view_.setSize(event.size.width, event.size.height);
-            view_.setCenter(event.size.width / 2, event.size.height / 2);
-            UpdateTitlePosition();
+        // Mouse navigation in canvas pixels; the caller has already mapped the event into them.
+        void Handle(const sf::Event& event){
+            switch(event.type){
+                case sf::Event::MouseWheelScrolled:
+                    if(event.mouseWheelScroll.wheel == sf::Mouse::VerticalWheel){
+                        Zoom(std::pow(0.8, event.mouseWheelScroll.delta), sf::Vector2f(event.mouseWheelScroll.x, event.mouseWheelScroll.y));
+                    }
+                    break;
+                case sf::Event::MouseButtonPressed:
+                    if(event.mouseButton.button == sf::Mouse::Left){
+                        dragging = true;
+                        drag_ = sf::Vector2i(event.mouseButton.x, event.mouseButton.y);
+                    }
+                    else if(event.mouseButton.button == sf::Mouse::Right){
+                        Home();
+                    }
+                    break;
+                case sf::Event::MouseButtonReleased:
+                    if(event.mouseButton.button == sf::Mouse::Left){
+                        dragging = false;
+                    }
+                    break;
+                case sf::Event::MouseMoved:
+                    if(dragging){
+                        sf::Vector2i at(event.mouseMove.x, event.mouseMove.y);
+                        Pan(sf::Vector2f(at - drag_));
+                        drag_ = at;
+                    }
+                    break;
+                default:
+                    break;
+            }
         }
+        Canvas(std::shared_ptr<RenderProfile> profile, const sf::FloatRect& area) : profile_(std::move(profile)), panel(true), fone_(Color::White()), grid_(Color({Color({180, 180, 180}, 200)})), axes_(Color::Black()){
+            Place(area);
+        }
+        friend class Figure;
         void DrawTitle() {
             if (title_enabled) {
-                profile_->Profile().setView(view_);
-                profile_->Profile().draw(text_);
+                profile_->Draw(text_);
+            }
+        }
+        void DrawOverlay(){
+            if(overlay_enabled){
+                char text[160];
+                stats_.Text(text, sizeof(text));
+                overlay_.Reset(font_, fontsize_ - 6);
+                overlay_.Add(text, sf::Vector2f(size_.x - 4 * space_, space_ / 4), axes_.Data());
+                profile_->Draw(overlay_);
             }
         }
+        // Moves what producers have queued into the stream rings. At most one queue's worth is
+        // taken per frame, so sustained input can't keep the render thread from drawing.
+        void Ingest(){
+            Chartify::Sample sample;
+            for(std::size_t k = feed_->Capacity(); k > 0 && feed_->Pop(sample); --k){
+                if(sample.series < rings_.size() && rings_[sample.series]){
+                    rings_[sample.series]->Append(sample.x, sample.y);
+                    stale_[sample.series] = true;
+                    dirty_ |= Dirty::Data;
+                    ++ingested_;
+                }
+            }
+        }
+        void Update(){
+            if(dirty_ & (Dirty::Data | Dirty::Size | Dirty::Style | Dirty::View)){
+                for(std::size_t i = 0; i < x_.size(); ++i){
+                    if(stale_[i]){
+                        Chartify::Stats::Scope scope(stats_, Chartify::Stage::Bounds);
+                        Measure(i);
+                    }
+                    if(stale_[i] || (dirty_ & (Dirty::Size | Dirty::Style | Dirty::View))){
+                        Build(i);
+                    }
+                    stale_[i] = false;
+                }
+                if(rebin){
+                    Chartify::Stats::Scope scope(stats_, Chartify::Stage::Projection);
+                    Bin();
+                }
+                {
+                    Chartify::Stats::Scope scope(stats_, Chartify::Stage::Grid);
+                    Clip();
+                    Grid();
+                    Axes();
+                }
+                Chartify::Stats::Scope scope(stats_, Chartify::Stage::Labels);
+                Labels();
+            }
+            if(dirty_ & (Dirty::Title | Dirty::Size)){
+                Chartify::Stats::Scope scope(stats_, Chartify::Stage::Title);
+                UpdateTitlePosition();
+            }
+            dirty_ = 0;
+        }
+        static Chartify::Stroke::Painter Painter(unsigned int linestyle){
+            switch(linestyle & Flag::Line){
+                case Flag::Solid: return Chartify::Stroke::Of<Chartify::Style::Solid>();
+                case Flag::Dashed: return Chartify::Stroke::Of<Chartify::Style::Dashed>();
+                case Flag::Dotted: return Chartify::Stroke::Of<Chartify::Style::Dotted>();
+            }
+            return nullptr;
+        }
+        static Chartify::Marker::Shape Shape(unsigned int linestyle){
+            if(linestyle & Flag::Square){
+                return Chartify::Marker::Square;
+            }
+            if(linestyle & Flag::Circle){
+                return Chartify::Marker::Circle;
+            }
+            if(linestyle & Flag::Cross){
+                return Chartify::Marker::Cross;
+            }
+            return Chartify::Marker::Point;
+        }
     public:
-        Canvas() : profile_(std::make_unique<RenderProfile>(Screen::Width, Screen::Height, sf::String("As Chartify!"))), fone_(Color::White()), grid_(Color({Color({180, 180, 180}, 200)})), axes_(Color::Black()){
-            view_.setSize(profile_->Profile().getSize().x, profile_->Profile().getSize().y);
-            view_.setCenter(profile_->Profile().getSize().x / 2, profile_->Profile().getSize().y / 2);
+        explicit Canvas(std::unique_ptr<RenderProfile> profile) : profile_(std::move(profile)), fone_(Color::White()), grid_(Color({Color({180, 180, 180}, 200)})), axes_(Color::Black()){
+            if(!profile_){
+                throw std::invalid_argument("Profile is absented!");
+            }
+            Place(area_);
         }
-        void ConfigurePlot(const std::vector<std::vector<double>>& x, const std::vector<std::vector<double>>& y, const std::vector<Color>& color, const std::vector<unsigned int>& linestyle){
+        Canvas() : Canvas(std::make_unique<RenderProfile>(Screen::Width, Screen::Height, sf::String("As Chartify!"))){}
+        void ConfigurePlot(std::vector<Chartify::Column> x, std::vector<Chartify::Column> y, const std::vector<Color>& color, const std::vector<unsigned int>& linestyle){
             if(x.size() != y.size() || x.size() != color.size() || x.size() != linestyle.size() || x.empty() || y.empty()){
                 throw std::invalid_argument("Invalid vectors data!");
             }
             for(std::size_t i = 0; i < x.size(); ++i){
-                if(x[i].size() != y[i].size() || x[i].size() <= 2 || y[i].size() <= 2){
+                if(x[i].Size() != y[i].Size() || x[i].Size() <= 2 || y[i].Size() <= 2){
                     throw std::invalid_argument("Invalid vectors data!");
                 }
-                x_.push_back(x[i]), y_.push_back(y[i]);
             }
+            x_ = std::move(x), y_ = std::move(y);
             color_ = color;
             linestyle_ = linestyle;
+            painter_.clear();
+            for(unsigned int style : linestyle_){
+                painter_.push_back(Painter(style));
+            }
+            rings_.clear();
+            pyramids_.clear();
+            stale_.clear();
+            Grow(x_.size());
+            Home();
+            dirty_ |= Dirty::Data;
+        }
+        void ConfigurePlot(const std::vector<std::vector<double>>& x, const std::vector<std::vector<double>>& y, const std::vector<Color>& color, const std::vector<unsigned int>& linestyle){
+            std::vector<Chartify::Column> cx, cy;
+            for(std::size_t i = 0; i < x.size(); ++i){
+                cx.push_back(Chartify::Column::Copy(x[i], precision_));
+            }
+            for(std::size_t i = 0; i < y.size(); ++i){
+                cy.push_back(Chartify::Column::Copy(y[i], precision_));
+            }
+            ConfigurePlot(std::move(cx), std::move(cy), color, linestyle);
+        }
+        void ConfigurePlot(std::vector<std::vector<double>>&& x, std::vector<std::vector<double>>&& y, const std::vector<Color>& color, const std::vector<unsigned int>& linestyle){
+            std::vector<Chartify::Column> cx, cy;
+            for(std::size_t i = 0; i < x.size(); ++i){
+                cx.emplace_back(std::move(x[i]));
+            }
+            for(std::size_t i = 0; i < y.size(); ++i){
+                cy.emplace_back(std::move(y[i]));
+            }
+            ConfigurePlot(std::move(cx), std::move(cy), color, linestyle);
+        }
+        std::size_t AddStream(std::size_t capacity, const Color& color, unsigned int linestyle, double window = 0){
+            auto ring = std::make_unique<Chartify::Ring>(capacity, window);
+            std::size_t series = x_.size();
+            x_.emplace_back(), y_.emplace_back();
+            color_.push_back(color);
+            linestyle_.push_back(linestyle);
+            painter_.push_back(Painter(linestyle));
+            Grow(series + 1);
+            rings_[series] = std::move(ring);
+            dirty_ |= Dirty::Data;
+            return series;
+        }
+        // Adds y = f(x) on [xmin, xmax] as a series sampled for the current plane size: dense
+        // where the curve bends on screen, sparse where it is straight. f is called from the
+        // shared pool's threads concurrently. Returns the series index.
+        template<class F>
+        std::size_t PlotFunction(F&& f, double xmin, double xmax, const Color& color, unsigned int linestyle){
+            const sf::FloatRect plane = Plane();
+            sampler_.Run(f, xmin, xmax, plane.width, plane.height, function_tolerance);
+            if(sampler_.X().size() <= 2){
+                throw std::invalid_argument("Function has too few finite values!");
+            }
+            std::size_t series = x_.size();
+            x_.push_back(Chartify::Column::Copy(sampler_.X(), precision_));
+            y_.push_back(Chartify::Column::Copy(sampler_.Y(), precision_));
+            color_.push_back(color);
+            linestyle_.push_back(linestyle);
+            painter_.push_back(Painter(linestyle));
+            Grow(series + 1);
+            dirty_ |= Dirty::Data;
+            return series;
+        }
+        // Attaches the min/max pyramid at path to series, building it there first unless it
+        // already holds one for the series' data. Keep it next to a mapped data file and pass
+        // that file as source, so the pyramid is rebuilt when the file changes. Once built,
+        // drawing a zoomed-out view of the series reads O(plane width) summaries instead of
+        // every sample. Density series and markers still use the samples.
+        void Index(std::size_t series, const std::string& path, const std::string& source = std::string()){
+            if(series >= x_.size() || rings_[series]){
+                throw std::invalid_argument("Series can't be indexed!");
+            }
+            pyramids_[series] = Chartify::Pyramid::Load(x_[series], y_[series], path, 256, source);
+            stale_[series] = true;
+            dirty_ |= Dirty::Data;
+        }
+        // Calls of f made by the last PlotFunction.
+        std::size_t Evaluations() const {return sampler_.Evaluations();}
+        void AppendPoints(std::size_t series, const double* x, const double* y, std::size_t n){
+            if(series >= rings_.size() || !rings_[series]){
+                throw std::invalid_argument("Series is not a stream!");
+            }
+            rings_[series]->Append(x, y, n);
+            stale_[series] = true;
+            dirty_ |= Dirty::Data;
+        }
+        void AppendPoints(std::size_t series, const std::vector<double>& x, const std::vector<double>& y){
+            if(x.size() != y.size()){
+                throw std::invalid_argument("Invalid vectors data!");
+            }
+            AppendPoints(series, x.data(), y.data(), x.size());
+        }
+        // Thread-safe input for stream series. Any thread may Push samples into the returned queue
+        // without blocking; the canvas drains it at the start of every Plot(), and Show() keeps
+        // drawing while samples arrive. Samples for series that aren't streams are ignored.
+        // Create the feed before starting producers.
+        Chartify::Queue<Chartify::Sample>& Feed(std::size_t capacity = 1 << 16){
+            if(!feed_){
+                feed_ = std::make_unique<Chartify::Queue<Chartify::Sample>>(capacity);
+            }
+            return *feed_;
+        }
+        std::uint64_t Ingested() const {return ingested_;}
+        const Chartify::Ring& Stream(std::size_t series) const {
+            if(series >= rings_.size() || !rings_[series]){
+                throw std::invalid_argument("Series is not a stream!");
+            }
+            return *rings_[series];
+        }
+        const sf::Vector2u& Size() const {return size_;}
+        void Storage(Chartify::Precision::Type precision){
+            precision_ = precision;
+        }
+        void Invalidate(unsigned int parts){
+            if(parts & Dirty::Data){
+                stale_.assign(stale_.size(), true);
+            }
+            dirty_ |= parts;
+        }
+        RenderProfile& Profile(){return *profile_;}
+        // Colormap of the density series, e.g. Chartify::Colormap::Magma().
+        void Colormap(const Chartify::Colormap& map){
+            colormap_ = map;
+            dirty_ |= Dirty::Style;
+        }
+        // Strokes a series with a custom style instead of its Flag line style,
+        // e.g. LineStyle(0, Chartify::Stroke::Of<DashDot>()); see stroke.h.
+        void LineStyle(std::size_t series, Chartify::Stroke::Painter painter){
+            if(series >= painter_.size()){
+                throw std::invalid_argument("Series doesn't exist!");
+            }
+            painter_[series] = painter;
+            dirty_ |= Dirty::Style;
+        }
+        void Style(const Color& fone, const Color& grid, const Color& axes){
+            fone_ = fone, grid_ = grid, axes_ = axes;
+            for(std::size_t k = 0; k < back_.getVertexCount(); ++k){
+                back_[k].color = fone_.Data();
+            }
+            dirty_ |= Dirty::Style;
+        }
+        // Profiling is off by default; while on, every Plot() records one frame into Stats().
+        void Profiling(bool enabled){
+            stats_.Enable(enabled);
+        }
+        const Chartify::Stats& Stats() const {return stats_;}
+        // Draws the last frame's stats in the top-right corner; turns profiling on.
+        void Overlay(bool enabled){
+            overlay_enabled = enabled;
+            if(enabled){
+                LoadFont();
+                stats_.Enable(true);
+            }
+            dirty_ |= Dirty::Frame;
+        }
+        // Scales the visible range by factor around a pixel of the plot plane (factor < 1 zooms in).
+        void Zoom(double factor, sf::Vector2f at){
+            const sf::FloatRect plane = Plane();
+            double fx = std::min(1.0, std::max(0.0, static_cast<double>(at.x - plane.left) / plane.width));
+            double fy = std::min(1.0, std::max(0.0, 1 - static_cast<double>(at.y - plane.top) / plane.height));
+            double cx = zoom_.x0 + fx * (zoom_.x1 - zoom_.x0), cy = zoom_.y0 + fy * (zoom_.y1 - zoom_.y0);
+            double w = std::min(1.0, std::max(min_zoom, (zoom_.x1 - zoom_.x0) * factor)), h = std::min(1.0, std::max(min_zoom, (zoom_.y1 - zoom_.y0) * factor));
+            zoom_ = Bounds{cx - fx * w, cx - fx * w + w, cy - fy * h, cy - fy * h + h};
+            Confine();
+        }
+        // Moves the visible range so that data follows a drag of delta pixels.
+        void Pan(sf::Vector2f delta){
+            const sf::FloatRect plane = Plane();
+            double dx = -delta.x / plane.width * (zoom_.x1 - zoom_.x0), dy = delta.y / plane.height * (zoom_.y1 - zoom_.y0);
+            zoom_ = Bounds{zoom_.x0 + dx, zoom_.x1 + dx, zoom_.y0 + dy, zoom_.y1 + dy};
+            Confine();
+        }
+        void Home(){
+            zoom_ = Bounds{0, 1, 0, 1};
+            dirty_ |= Dirty::View;
         }
         void Plot(){
-            profile_->Profile().clear(fone_.Data());
+            if(panel){
+                throw std::logic_error("Panels are drawn by their Figure!");
+            }
+            stats_.Begin();
+            Prepare();
+            profile_->Clear(fone_.Data());
+            Render();
+            profile_->Display();
+            stats_.End(profile_->DrawCalls(), profile_->Vertices());
+        }
+        void SaveImage(const std::string& path){
+            Plot();
+            WriteImage(profile_->Capture(), path);
+        }
+        // Writes the current view as SVG or PDF, chosen by the extension of path. Series are
+        // reduced to the output resolution before they are written: lines go through M4 and
+        // then Douglas-Peucker within export_tolerance pixels, markers keep one per pixel. File
+        // size and write time therefore follow the plot size, not the sample count. Density
+        // series and custom LineStyle() painters are not exported; the latter are written solid.
+        void Export(const std::string& path){
+            Prepare();
+            std::unique_ptr<Chartify::VectorWriter> out = Chartify::VectorWriter::Open(path);
+            out->Begin(size_.x, size_.y, fone_.Data());
+            const sf::FloatRect plane = Plane();
+            out->Clip(sf::FloatRect(plane.left - 2, plane.top - 2, plane.width + 4, plane.height + 4));
             for(std::size_t i = 0; i < x_.size(); ++i){
-                it_x.push_back(std::minmax_element(x_[i].begin(), x_[i].end()));
-                it_y.push_back(std::minmax_element(y_[i].begin(), y_[i].end()));
-                double u = *it_x[i].second - *it_x[i].first;
-                double v = *it_y[i].second - *it_y[i].first;
-                if(u == 0){u = 1;}
-                if(v == 0){v = 1;}
-                std::vector<sf::Vertex> c;
-                for(std::size_t l = 0; l < x_[i].size(); ++l){
-                    float scr_x = space_ + extra_space + ((x_[i][l] - *it_x[i].first) / (u)) * (profile_->Data().x - 2 * space_ - extra_space * 2);
-                    float scr_y = space_ + extra_space + (profile_->Data().y - 2 * space_ - 2 * extra_space) * (1 - ((y_[i][l] - *it_y[i].first) / (v)));
-                    c.emplace_back(sf::Vector2f(scr_x, scr_y), color_[i].Data());
-                }
-                switch(linestyle_[i]){
-                    case Flag::Solid: Solid(c, color_[i]);
-                    break;
-                    case Flag::Dashed: Dashed(c, color_[i]);
-                    break;
-                    case Flag::Dotted: Dotted(c, color_[i]);
-                    break;
+                const unsigned int style = linestyle_[i];
+                if(style & Flag::Density){
+                    continue;
+                }
+                const Bounds b = Visible(i);
+                const Chartify::Affine affine = Chartify::Affine::Fit(b.x0, b.x1, b.y0, b.y1, plane);
+                const sf::Color& color = color_[i].Data();
+                if(style & Flag::Line){
+                    chart_.clear();
+                    Chartify::Decimator m4(chart_, color);
+                    Blocks(i, b, affine, color, [&](const sf::Vertex* v, std::size_t m){
+                        for(std::size_t l = 0; l < m; ++l){
+                            m4.Push(v[l].position);
+                        }
+                    }, true);
+                    m4.Flush();
+                    const std::vector<sf::Vector2f>& line = simplifier_.Run(chart_.data(), chart_.size(), export_tolerance);
+                    if(style & Flag::Dotted){
+                        out->Polyline(line.data(), line.size(), color, Chartify::Style::Dotted::width, {0, Chartify::Style::Dotted::pattern[0]}, true);
+                    }
+                    else if(style & Flag::Dashed){
+                        const auto& dash = Chartify::Style::Dashed::pattern;
+                        out->Polyline(line.data(), line.size(), color, Chartify::Style::Dashed::width, std::vector<float>(dash.begin(), dash.end()), false);
+                    }
+                    else{
+                        out->Polyline(line.data(), line.size(), color, Chartify::Style::Solid::width, {}, false);
+                    }
+                }
+                if(style & Flag::Marker){
+                    centres_.clear();
+                    scatter_.Reset(plane);
+                    Blocks(i, b, affine, color, [&](const sf::Vertex* v, std::size_t m){
+                        for(std::size_t l = 0; l < m; ++l){
+                            if(scatter_.Keep(v[l].position)){
+                                centres_.emplace_back(std::floor(v[l].position.x) + 0.5f, std::floor(v[l].position.y) + 0.5f);
+                            }
+                        }
+                    });
+                    out->Markers(centres_.data(), centres_.size(), Shape(style), marker_size, color);
+                }
+            }
+            out->Unclip();
+            for(const auto& lines : {std::make_pair(&grid_lines_, &grid_), std::make_pair(&axes_lines_, &axes_)}){
+                if(lines.first->getVertexCount() > 0){
+                    out->Lines(&(*lines.first)[0], lines.first->getVertexCount(), lines.second->Data(), 1);
                 }
             }
-            Grid();
-            Axes();
-            DrawTitle();
-            profile_->Profile().display();
+            if(!x_.empty()){
+                const float size = static_cast<float>(fontsize_ - 4);
+                Ticks([&](const char* text, sf::Vector2f at){out->Text(text, sf::Vector2f(at.x, at.y + size), size, axes_.Data());});
+            }
+            if(title_enabled){
+                sf::Vector2f extent = text_.Measure(title_);
+                out->Text(title_, sf::Vector2f(view_.getCenter().x - extent.x / 2, space_ / 2 - fontsize_ / 4 + fontsize_), fontsize_, Color::Black().Data());
+            }
+            out->End();
+            out->Close();
         }
         void Title(const sf::String& title){
             title_ = title;
-            title_enabled = true;
-            text_.setString(title_);
-            InitTitle();
+            title_enabled = !title_.isEmpty();
+            if(title_enabled){
+                LoadFont();
+            }
+            dirty_ |= Dirty::Title;
         }
         void Show() {
+            if(panel){
+                throw std::logic_error("Panels are shown by their Figure!");
+            }
             sf::RenderWindow& s = profile_->Profile();
+            sf::Event event;
+            dirty_ |= Dirty::Frame;
             while(s.isOpen()){
-                sf::Event event;
-                while(s.pollEvent(event)){
-                    switch(event.type){
-                        case sf::Event::Closed:
-                            s.close();
-                            break;
-                        case sf::Event::Resized:
-                            HandleTitleResize(event);
-                            break;
+                if(feed_ && !feed_->Empty()){
+                    dirty_ |= Dirty::Data;
+                }
+                if(dirty_){
+                    Plot();
+                }
+                if(feed_){
+                    if(!s.pollEvent(event)){
+                        sf::sleep(sf::milliseconds(frame_ms));
+                        continue;
                     }
                 }
-                Plot();
+                else if(!s.waitEvent(event)){
+                    break;
+                }
+                switch(event.type){
+                    case sf::Event::Closed:
+                        s.close();
+                        break;
+                    case sf::Event::Resized:
+                        HandleResize(event);
+                        break;
+                    case sf::Event::GainedFocus:
+                        dirty_ |= Dirty::Frame;
+                        break;
+                    default:
+                        Handle(event);
+                        break;
+                }
             }
         }
         virtual ~Canvas() = default;
     };
+    // Grid of Canvas panels in one window. All panels share the profile (one window, one GL
+    // context, the process-wide fonts) and a frame is one clear, one draw pass over the panels,
+    // each into its own viewport, and one display. A panel only rebuilds the geometry it has
+    // marked dirty, and Show() only draws frames when some panel changed.
+    class Figure{
+        std::shared_ptr<RenderProfile> profile_;
+        std::size_t rows_, cols_;
+        std::vector<std::unique_ptr<Canvas>> panels_;
+        Color fone_;
+        Canvas* active_ = nullptr;
+        sf::FloatRect Area(std::size_t row, std::size_t col) const {
+            return sf::FloatRect(static_cast<float>(col) / cols_, static_cast<float>(row) / rows_, 1.0f / cols_, 1.0f / rows_);
+        }
+        // Panel under a window pixel, with the pixel moved into that panel's coordinates.
+        Canvas* At(int& x, int& y){
+            const sf::Vector2u& size = profile_->Data();
+            std::size_t col = std::min(cols_ - 1, static_cast<std::size_t>(std::max(0, x)) * cols_ / size.x);
+            std::size_t row = std::min(rows_ - 1, static_cast<std::size_t>(std::max(0, y)) * rows_ / size.y);
+            Canvas* panel = panels_[row * cols_ + col].get();
+            x -= static_cast<int>(panel->area_.left * size.x), y -= static_cast<int>(panel->area_.top * size.y);
+            return panel;
+        }
+        void Dispatch(sf::Event event){
+            Canvas* panel = nullptr;
+            switch(event.type){
+                case sf::Event::MouseWheelScrolled:
+                    panel = At(event.mouseWheelScroll.x, event.mouseWheelScroll.y);
+                    break;
+                case sf::Event::MouseButtonPressed:
+                    panel = At(event.mouseButton.x, event.mouseButton.y);
+                    if(event.mouseButton.button == sf::Mouse::Left){
+                        active_ = panel;
+                    }
+                    break;
+                case sf::Event::MouseButtonReleased:{
+                    panel = active_ ? active_ : At(event.mouseButton.x, event.mouseButton.y);
+                    if(event.mouseButton.button == sf::Mouse::Left){
+                        active_ = nullptr;
+                    }
+                    break;
+                }
+                case sf::Event::MouseMoved:{
+                    // A drag stays with the panel it started in, even when the cursor leaves it.
+                    if(!active_){
+                        return;
+                    }
+                    panel = active_;
+                    const sf::Vector2u& size = profile_->Data();
+                    event.mouseMove.x -= static_cast<int>(panel->area_.left * size.x), event.mouseMove.y -= static_cast<int>(panel->area_.top * size.y);
+                    break;
+                }
+                default:
+                    return;
+            }
+            panel->Handle(event);
+        }
+    public:
+        Figure(std::size_t rows, std::size_t cols, std::unique_ptr<RenderProfile> profile) : profile_(std::move(profile)), rows_(rows), cols_(cols), fone_(Color::White()){
+            if(!profile_){
+                throw std::invalid_argument("Profile is absented!");
+            }
+            if(rows_ == 0 || cols_ == 0){
+                throw std::invalid_argument("Figure needs at least one panel!");
+            }
+            for(std::size_t r = 0; r < rows_; ++r){
+                for(std::size_t c = 0; c < cols_; ++c){
+                    panels_.emplace_back(new Canvas(profile_, Area(r, c)));
+                }
+            }
+        }
+        Figure(std::size_t rows, std::size_t cols) : Figure(rows, cols, std::make_unique<RenderProfile>(Screen::Width, Screen::Height, sf::String("As Chartify!"))){}
+        Figure(const Figure&) = delete;
+        Figure& operator=(const Figure&) = delete;
+        Canvas& Subplot(std::size_t row, std::size_t col){
+            if(row >= rows_ || col >= cols_){
+                throw std::out_of_range("Subplot doesn't exist!");
+            }
+            return *panels_[row * cols_ + col];
+        }
+        std::size_t Rows() const {return rows_;}
+        std::size_t Cols() const {return cols_;}
+        RenderProfile& Profile(){return *profile_;}
+        bool Pending() const {
+            for(const std::unique_ptr<Canvas>& panel : panels_){
+                if(panel->Pending()){
+                    return true;
+                }
+            }
+            return false;
+        }
+        // One frame for all panels. Every panel with profiling on records its own share of it.
+        void Plot(){
+            profile_->Clear(fone_.Data());
+            for(const std::unique_ptr<Canvas>& panel : panels_){
+                std::size_t draws = profile_->DrawCalls(), vertices = profile_->Vertices();
+                panel->stats_.Begin();
+                panel->Prepare();
+                panel->Render();
+                panel->stats_.End(profile_->DrawCalls() - draws, profile_->Vertices() - vertices);
+            }
+            profile_->Display();
+        }
+        void SaveImage(const std::string& path){
+            Plot();
+            WriteImage(profile_->Capture(), path);
+        }
+        void Show(){
+            sf::RenderWindow& s = profile_->Profile();
+            sf::Event event;
+            bool redraw = true, streaming = false;
+            for(const std::unique_ptr<Canvas>& panel : panels_){
+                streaming = streaming || panel->feed_;
+            }
+            while(s.isOpen()){
+                if(redraw || Pending()){
+                    Plot();
+                    redraw = false;
+                }
+                if(streaming){
+                    if(!s.pollEvent(event)){
+                        sf::sleep(sf::milliseconds(panels_[0]->frame_ms));
+                        continue;
+                    }
+                }
+                else if(!s.waitEvent(event)){
+                    break;
+                }
+                switch(event.type){
+                    case sf::Event::Closed:
+                        s.close();
+                        break;
+                    case sf::Event::Resized:
+                        profile_->Resize(event.size.width, event.size.height);
+                        for(const std::unique_ptr<Canvas>& panel : panels_){
+                            panel->Place(panel->area_);
+                        }
+                        break;
+                    case sf::Event::GainedFocus:
+                        redraw = true;
+                        break;
+                    default:
+                        Dispatch(event);
+                        break;
+                }
+            }
+        }
+    };
 };
\ No newline at end of file
@@ -0,0 +1,122 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+namespace Chartify{
+    // Persistent worker threads for data-parallel loops. For(count, f) calls f(index, worker)
+    // for every index in [0, count); worker is in [0, Size()) and is stable for the duration of
+    // the call, so callers can keep one scratch buffer per worker. The calling thread takes
+    // part as the last worker. A For issued from inside one of this pool's tasks runs inline on
+    // that task's worker.
+    class ThreadPool{
+        std::vector<std::thread> threads_;
+        std::mutex mutex_, run_;
+        std::condition_variable wake_, done_;
+        std::function<void(std::size_t, std::size_t)> task_;
+        std::size_t count_ = 0, active_ = 0;
+        std::atomic<std::size_t> next_{0};
+        std::uint64_t generation_ = 0;
+        std::exception_ptr error_;
+        bool stop_ = false;
+        struct Current{
+            const ThreadPool* pool;
+            std::size_t worker;
+        };
+        static Current& Inside(){
+            thread_local Current current{nullptr, 0};
+            return current;
+        }
+        void Drain(std::size_t worker){
+            Current outer = Inside();
+            Inside() = Current{this, worker};
+            for(std::size_t i = next_++; i < count_; i = next_++){
+                try{
+                    task_(i, worker);
+                }
+                catch(...){
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if(!error_){
+                        error_ = std::current_exception();
+                    }
+                    next_ = count_;
+                }
+            }
+            Inside() = outer;
+        }
+        void Work(std::size_t worker){
+            std::uint64_t seen = 0;
+            while(true){
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    wake_.wait(lock, [&]{return stop_ || generation_ != seen;});
+                    if(stop_){
+                        return;
+                    }
+                    seen = generation_;
+                }
+                Drain(worker);
+                std::lock_guard<std::mutex> lock(mutex_);
+                if(--active_ == 0){
+                    done_.notify_all();
+                }
+            }
+        }
+    public:
+        explicit ThreadPool(std::size_t threads = std::max(1u, std::thread::hardware_concurrency())){
+            for(std::size_t i = 1; i < threads; ++i){
+                threads_.emplace_back(&ThreadPool::Work, this, i - 1);
+            }
+        }
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+        std::size_t Size() const {return threads_.size() + 1;}
+        void For(std::size_t count, const std::function<void(std::size_t, std::size_t)>& f){
+            if(Inside().pool == this || threads_.empty()){
+                std::size_t worker = Inside().pool == this ? Inside().worker : threads_.size();
+                for(std::size_t i = 0; i < count; ++i){
+                    f(i, worker);
+                }
+                return;
+            }
+            std::lock_guard<std::mutex> run(run_);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                task_ = f, count_ = count, next_ = 0, active_ = threads_.size(), error_ = nullptr;
+                ++generation_;
+            }
+            wake_.notify_all();
+            Drain(threads_.size());
+            std::exception_ptr error;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                done_.wait(lock, [&]{return active_ == 0;});
+                task_ = nullptr;
+                error = error_;
+            }
+            if(error){
+                std::rethrow_exception(error);
+            }
+        }
+        static ThreadPool& Shared(){
+            static ThreadPool pool;
+            return pool;
+        }
+        ~ThreadPool(){
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            wake_.notify_all();
+            for(std::thread& t : threads_){
+                t.join();
+            }
+        }
+    };
+};
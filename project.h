@@ -0,0 +1,163 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+namespace Chartify{
+    // Data-to-pixel transform: screen = offset + scale * value, per axis.
+    struct Affine{
+        double ox, sx, oy, sy;
+        static Affine Fit(double x0, double x1, double y0, double y1, const sf::FloatRect& area){
+            double u = x1 - x0, v = y1 - y0;
+            if(u == 0){u = 1;}
+            if(v == 0){v = 1;}
+            double sx = area.width / u, sy = -area.height / v;
+            return Affine{area.left - x0 * sx, sx, area.top + area.height - y0 * sy, sy};
+        }
+    };
+    // Bounds and projection kernels over contiguous columns. The vector paths are selected at
+    // compile time (AVX, then SSE2) and fall back to scalar loops elsewhere and for the tails.
+    class Kernel{
+        template<class T>
+        static std::pair<double, double> Scalar(const T* p, std::size_t n, T lo, T hi){
+            for(std::size_t i = 0; i < n; ++i){
+                lo = std::min(lo, p[i]), hi = std::max(hi, p[i]);
+            }
+            return std::make_pair(static_cast<double>(lo), static_cast<double>(hi));
+        }
+        static void Store(sf::Vertex* out, float x, float y, const sf::Color& color){
+            out->position.x = x, out->position.y = y, out->color = color;
+        }
+    public:
+        static std::pair<double, double> Bounds(const double* p, std::size_t n){
+            if(n == 0){
+                return std::make_pair(0.0, 0.0);
+            }
+            std::size_t i = 0;
+            double lo = p[0], hi = p[0];
+#if defined(__AVX__)
+            if(n >= 4){
+                __m256d vlo = _mm256_loadu_pd(p), vhi = vlo;
+                for(i = 4; i + 4 <= n; i += 4){
+                    __m256d v = _mm256_loadu_pd(p + i);
+                    vlo = _mm256_min_pd(vlo, v), vhi = _mm256_max_pd(vhi, v);
+                }
+                alignas(32) double l[4], h[4];
+                _mm256_store_pd(l, vlo), _mm256_store_pd(h, vhi);
+                lo = std::min(std::min(l[0], l[1]), std::min(l[2], l[3]));
+                hi = std::max(std::max(h[0], h[1]), std::max(h[2], h[3]));
+            }
+#elif defined(__SSE2__)
+            if(n >= 2){
+                __m128d vlo = _mm_loadu_pd(p), vhi = vlo;
+                for(i = 2; i + 2 <= n; i += 2){
+                    __m128d v = _mm_loadu_pd(p + i);
+                    vlo = _mm_min_pd(vlo, v), vhi = _mm_max_pd(vhi, v);
+                }
+                alignas(16) double l[2], h[2];
+                _mm_store_pd(l, vlo), _mm_store_pd(h, vhi);
+                lo = std::min(l[0], l[1]), hi = std::max(h[0], h[1]);
+            }
+#endif
+            return Scalar(p + i, n - i, lo, hi);
+        }
+        static std::pair<double, double> Bounds(const float* p, std::size_t n){
+            if(n == 0){
+                return std::make_pair(0.0, 0.0);
+            }
+            std::size_t i = 0;
+            float lo = p[0], hi = p[0];
+#if defined(__AVX__)
+            if(n >= 8){
+                __m256 vlo = _mm256_loadu_ps(p), vhi = vlo;
+                for(i = 8; i + 8 <= n; i += 8){
+                    __m256 v = _mm256_loadu_ps(p + i);
+                    vlo = _mm256_min_ps(vlo, v), vhi = _mm256_max_ps(vhi, v);
+                }
+                alignas(32) float l[8], h[8];
+                _mm256_store_ps(l, vlo), _mm256_store_ps(h, vhi);
+                lo = *std::min_element(l, l + 8), hi = *std::max_element(h, h + 8);
+            }
+#elif defined(__SSE2__)
+            if(n >= 4){
+                __m128 vlo = _mm_loadu_ps(p), vhi = vlo;
+                for(i = 4; i + 4 <= n; i += 4){
+                    __m128 v = _mm_loadu_ps(p + i);
+                    vlo = _mm_min_ps(vlo, v), vhi = _mm_max_ps(vhi, v);
+                }
+                alignas(16) float l[4], h[4];
+                _mm_store_ps(l, vlo), _mm_store_ps(h, vhi);
+                lo = *std::min_element(l, l + 4), hi = *std::max_element(h, h + 4);
+            }
+#endif
+            return Scalar(p + i, n - i, lo, hi);
+        }
+        static void Project(const double* x, const double* y, std::size_t n, const Affine& a, const sf::Color& color, sf::Vertex* out){
+            std::size_t i = 0;
+#if defined(__AVX__)
+            const __m256d ox = _mm256_set1_pd(a.ox), sx = _mm256_set1_pd(a.sx), oy = _mm256_set1_pd(a.oy), sy = _mm256_set1_pd(a.sy);
+            for(; i + 4 <= n; i += 4){
+                __m128 px = _mm256_cvtpd_ps(_mm256_add_pd(ox, _mm256_mul_pd(sx, _mm256_loadu_pd(x + i))));
+                __m128 py = _mm256_cvtpd_ps(_mm256_add_pd(oy, _mm256_mul_pd(sy, _mm256_loadu_pd(y + i))));
+                alignas(16) float fx[4], fy[4];
+                _mm_store_ps(fx, px), _mm_store_ps(fy, py);
+                for(std::size_t k = 0; k < 4; ++k){
+                    Store(out + i + k, fx[k], fy[k], color);
+                }
+            }
+#elif defined(__SSE2__)
+            const __m128d ox = _mm_set1_pd(a.ox), sx = _mm_set1_pd(a.sx), oy = _mm_set1_pd(a.oy), sy = _mm_set1_pd(a.sy);
+            for(; i + 2 <= n; i += 2){
+                __m128 px = _mm_cvtpd_ps(_mm_add_pd(ox, _mm_mul_pd(sx, _mm_loadu_pd(x + i))));
+                __m128 py = _mm_cvtpd_ps(_mm_add_pd(oy, _mm_mul_pd(sy, _mm_loadu_pd(y + i))));
+                alignas(16) float fx[4], fy[4];
+                _mm_store_ps(fx, px), _mm_store_ps(fy, py);
+                Store(out + i, fx[0], fy[0], color), Store(out + i + 1, fx[1], fy[1], color);
+            }
+#endif
+            for(; i < n; ++i){
+                Store(out + i, static_cast<float>(a.ox + a.sx * x[i]), static_cast<float>(a.oy + a.sy * y[i]), color);
+            }
+        }
+        static void Project(const float* x, const float* y, std::size_t n, const Affine& a, const sf::Color& color, sf::Vertex* out){
+            std::size_t i = 0;
+            const float fox = static_cast<float>(a.ox), fsx = static_cast<float>(a.sx), foy = static_cast<float>(a.oy), fsy = static_cast<float>(a.sy);
+#if defined(__AVX__)
+            const __m256 ox = _mm256_set1_ps(fox), sx = _mm256_set1_ps(fsx), oy = _mm256_set1_ps(foy), sy = _mm256_set1_ps(fsy);
+            for(; i + 8 <= n; i += 8){
+                alignas(32) float fx[8], fy[8];
+                _mm256_store_ps(fx, _mm256_add_ps(ox, _mm256_mul_ps(sx, _mm256_loadu_ps(x + i))));
+                _mm256_store_ps(fy, _mm256_add_ps(oy, _mm256_mul_ps(sy, _mm256_loadu_ps(y + i))));
+                for(std::size_t k = 0; k < 8; ++k){
+                    Store(out + i + k, fx[k], fy[k], color);
+                }
+            }
+#elif defined(__SSE2__)
+            const __m128 ox = _mm_set1_ps(fox), sx = _mm_set1_ps(fsx), oy = _mm_set1_ps(foy), sy = _mm_set1_ps(fsy);
+            for(; i + 4 <= n; i += 4){
+                alignas(16) float fx[4], fy[4];
+                _mm_store_ps(fx, _mm_add_ps(ox, _mm_mul_ps(sx, _mm_loadu_ps(x + i))));
+                _mm_store_ps(fy, _mm_add_ps(oy, _mm_mul_ps(sy, _mm_loadu_ps(y + i))));
+                for(std::size_t k = 0; k < 4; ++k){
+                    Store(out + i + k, fx[k], fy[k], color);
+                }
+            }
+#endif
+            for(; i < n; ++i){
+                Store(out + i, fox + fsx * x[i], foy + fsy * y[i], color);
+            }
+        }
+        // Mixed-precision columns take the scalar path.
+        template<class X, class Y>
+        static void Project(const X* x, const Y* y, std::size_t n, const Affine& a, const sf::Color& color, sf::Vertex* out){
+            for(std::size_t i = 0; i < n; ++i){
+                Store(out + i, static_cast<float>(a.ox + a.sx * x[i]), static_cast<float>(a.oy + a.sy * y[i]), color);
+            }
+        }
+    };
+};
@@ -0,0 +1,313 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "loader.h"
+#include "series.h"
+namespace Chartify{
+    // Multi-resolution min/max index of a series, stored in a file next to the data and memory
+    // mapped for browsing. Level k summarizes blocks of base << k consecutive samples by their
+    // first and last x, first and last y, y range and count, so a view spanning S samples over
+    // W pixels is drawn from the level with a few blocks per pixel: O(W) nodes are read
+    // whatever S is, and only the pages of the visible range are ever touched. Build writes
+    // the file in one streaming pass over the columns; Load reuses it while it still matches.
+    // Files are in native byte order and are replaced, never rewritten in place, so pyramids
+    // already mapped keep their old contents.
+    class Pyramid{
+    public:
+        struct Node{
+            double x0, x1, first, last, low, high;
+            std::uint64_t count;
+            // 1 if the low came before the high.
+            std::uint64_t order;
+        };
+    private:
+        // fingerprint hashes a strided sample of the data; source_size and source_time stamp
+        // the data file it was built from, if one was given.
+        struct Header{
+            char magic[8];
+            std::uint64_t samples, base, levels, sorted;
+            double x_min, x_max;
+            std::uint64_t fingerprint, source_size, source_time;
+        };
+        static constexpr char magic[8] = {'C', 'H', 'P', 'Y', 'R', 'M', 'D', '2'};
+        static constexpr std::size_t chunk = 256;
+        static constexpr std::size_t fingerprint_samples = 1 << 16;
+        std::shared_ptr<Mapping> mapping_;
+        const Header* header_ = nullptr;
+        std::vector<const Node*> nodes_;
+        std::vector<std::size_t> counts_;
+        static std::vector<std::size_t> Counts(std::uint64_t samples, std::uint64_t base){
+            std::vector<std::size_t> counts;
+            std::uint64_t count = (samples + base - 1) / base;
+            while(true){
+                counts.push_back(static_cast<std::size_t>(count));
+                if(count <= 1){
+                    return counts;
+                }
+                count = (count + 1) / 2;
+            }
+        }
+        static Node Merge(const Node& a, const Node& b){
+            const bool low = !(b.low < a.low), high = !(b.high > a.high);
+            Node n{a.x0, b.x1, a.first, b.last, low ? a.low : b.low, high ? a.high : b.high, a.count + b.count, 0};
+            n.order = low == high ? (low ? a.order : b.order) : low;
+            return n;
+        }
+        // FNV-1a over the bits of every stride-th sample of both columns and of the last one.
+        static std::uint64_t Fingerprint(const Column& x, const Column& y){
+            std::uint64_t hash = 14695981039346656037ull;
+            auto mix = [&](double v){
+                unsigned char bytes[sizeof(double)];
+                std::memcpy(bytes, &v, sizeof(double));
+                for(unsigned char b : bytes){
+                    hash = (hash ^ b) * 1099511628211ull;
+                }
+            };
+            const std::size_t n = x.Size(), stride = std::max<std::size_t>(1, n / fingerprint_samples);
+            for(std::size_t i = 0; i < n; i += stride){
+                mix(x[i]), mix(y[i]);
+            }
+            mix(x[n - 1]), mix(y[n - 1]);
+            return hash;
+        }
+        // Size and modification time of source; false if it can't be read.
+        static bool Stamp(const std::string& source, std::uint64_t& size, std::uint64_t& time){
+#if defined(_WIN32)
+            WIN32_FILE_ATTRIBUTE_DATA data;
+            if(!GetFileAttributesExA(source.c_str(), GetFileExInfoStandard, &data)){
+                return false;
+            }
+            size = (static_cast<std::uint64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+            time = (static_cast<std::uint64_t>(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+#else
+            struct stat st;
+            if(::stat(source.c_str(), &st) != 0){
+                return false;
+            }
+            size = static_cast<std::uint64_t>(st.st_size), time = static_cast<std::uint64_t>(st.st_mtime);
+#endif
+            return true;
+        }
+        static void Replace(const std::string& from, const std::string& to){
+#if defined(_WIN32)
+            const bool replaced = MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+            const bool replaced = std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+            if(!replaced){
+                std::remove(from.c_str());
+                throw std::runtime_error("Failed to replace " + to);
+            }
+        }
+        static void Seek(std::FILE* file, std::uint64_t offset){
+#if defined(_WIN32)
+            const int failed = _fseeki64(file, static_cast<__int64>(offset), SEEK_SET);
+#else
+            const int failed = fseeko(file, static_cast<off_t>(offset), SEEK_SET);
+#endif
+            if(failed){
+                throw std::runtime_error("Failed to seek in pyramid file!");
+            }
+        }
+    public:
+        explicit Pyramid(const std::string& path) : mapping_(std::make_shared<Mapping>(path)){
+            const char* data = static_cast<const char*>(mapping_->Data());
+            if(mapping_->Size() < sizeof(Header) || std::memcmp(data, magic, sizeof(magic)) != 0){
+                throw std::runtime_error("Not a pyramid file: " + path);
+            }
+            header_ = reinterpret_cast<const Header*>(data);
+            if(header_->base == 0 || header_->samples == 0){
+                throw std::runtime_error("Corrupt pyramid file: " + path);
+            }
+            counts_ = Counts(header_->samples, header_->base);
+            std::uint64_t offset = sizeof(Header);
+            for(std::size_t count : counts_){
+                nodes_.push_back(reinterpret_cast<const Node*>(data + offset));
+                offset += count * sizeof(Node);
+            }
+            if(counts_.size() != header_->levels || offset != mapping_->Size()){
+                throw std::runtime_error("Corrupt pyramid file: " + path);
+            }
+        }
+        // Writes the pyramid of the series (x, y) to path; blocks of level 0 hold base samples.
+        // source, if given, is the data file the columns come from. The pyramid is written to a
+        // temporary file next to path and then renamed over it; on Windows that fails while
+        // path is still mapped.
+        static void Build(const Column& x, const Column& y, const std::string& path, std::size_t base = 256, const std::string& source = std::string()){
+            if(x.Size() != y.Size() || x.Empty() || base == 0){
+                throw std::invalid_argument("Invalid pyramid data!");
+            }
+            Header header{};
+            if(!source.empty() && !Stamp(source, header.source_size, header.source_time)){
+                throw std::runtime_error("Failed to open " + source);
+            }
+            const std::string temporary = path + ".tmp";
+            std::unique_ptr<std::FILE, int(*)(std::FILE*)> file(std::fopen(temporary.c_str(), "wb"), &std::fclose);
+            if(!file){
+                throw std::runtime_error("Failed to open " + temporary);
+            }
+            const std::vector<std::size_t> counts = Counts(x.Size(), base);
+            struct Level{
+                std::uint64_t offset;
+                std::vector<Node> buffer;
+                Node carry;
+                bool carried;
+            };
+            std::vector<Level> levels(counts.size());
+            std::uint64_t offset = sizeof(Header);
+            for(std::size_t k = 0; k < counts.size(); ++k){
+                levels[k].offset = offset, levels[k].carried = false;
+                levels[k].buffer.reserve(chunk);
+                offset += counts[k] * sizeof(Node);
+            }
+            auto flush = [&](Level& level){
+                if(!level.buffer.empty()){
+                    Seek(file.get(), level.offset);
+                    std::fwrite(level.buffer.data(), sizeof(Node), level.buffer.size(), file.get());
+                    level.offset += level.buffer.size() * sizeof(Node);
+                    level.buffer.clear();
+                }
+            };
+            // Every node is written to its level and paired up with its left neighbour, like
+            // the carries of a binary counter.
+            auto emit = [&](std::size_t k, Node node){
+                for(; k < levels.size(); ++k){
+                    Level& level = levels[k];
+                    level.buffer.push_back(node);
+                    if(level.buffer.size() == chunk){
+                        flush(level);
+                    }
+                    if(!level.carried){
+                        level.carry = node, level.carried = true;
+                        return;
+                    }
+                    node = Merge(level.carry, node);
+                    level.carried = false;
+                }
+            };
+            std::memcpy(header.magic, magic, sizeof(magic));
+            header.samples = x.Size(), header.base = base, header.levels = counts.size(), header.sorted = 1;
+            header.fingerprint = Fingerprint(x, y);
+            header.x_min = HUGE_VAL, header.x_max = -HUGE_VAL;
+            Visit(x, y, [&](auto px, auto py){
+                Node node{};
+                std::size_t low = 0, high = 0;
+                for(std::size_t i = 0; i < x.Size(); ++i){
+                    const double u = px[i], v = py[i];
+                    if(i > 0 && u < px[i - 1]){
+                        header.sorted = 0;
+                    }
+                    header.x_min = std::min(header.x_min, u), header.x_max = std::max(header.x_max, u);
+                    if(node.count == 0){
+                        node = Node{u, u, v, v, v, v, 0, 1};
+                        low = high = 0;
+                    }
+                    if(v < node.low){
+                        node.low = v, low = node.count;
+                    }
+                    if(v > node.high){
+                        node.high = v, high = node.count;
+                    }
+                    node.x1 = u, node.last = v;
+                    if(++node.count == base){
+                        node.order = low <= high;
+                        emit(0, node);
+                        node.count = 0;
+                    }
+                }
+                if(node.count > 0){
+                    node.order = low <= high;
+                    emit(0, node);
+                }
+            });
+            // The odd nodes left at the tail of a level move up alone.
+            for(std::size_t k = 0; k + 1 < levels.size(); ++k){
+                if(levels[k].carried){
+                    levels[k].carried = false;
+                    emit(k + 1, levels[k].carry);
+                }
+            }
+            for(Level& level : levels){
+                flush(level);
+            }
+            Seek(file.get(), 0);
+            std::fwrite(&header, sizeof(header), 1, file.get());
+            const bool failed = std::ferror(file.get()) != 0;
+            if(std::fclose(file.release()) != 0 || failed){
+                std::remove(temporary.c_str());
+                throw std::runtime_error("Failed to write " + temporary);
+            }
+            Replace(temporary, path);
+        }
+        // Opens the pyramid at path if it was built for this series with the same base, or
+        // builds it there first. The data is recognized by its size and a fingerprint of every
+        // few thousandth sample; give the data file as source to also rebuild whenever that
+        // file changes.
+        static std::shared_ptr<const Pyramid> Load(const Column& x, const Column& y, const std::string& path, std::size_t base = 256, const std::string& source = std::string()){
+            if(x.Size() != y.Size() || x.Empty()){
+                throw std::invalid_argument("Invalid pyramid data!");
+            }
+            try{
+                auto pyramid = std::make_shared<const Pyramid>(path);
+                const Header& header = *pyramid->header_;
+                std::uint64_t size = 0, time = 0;
+                const bool stamped = source.empty() || (Stamp(source, size, time) && size == header.source_size && time == header.source_time);
+                if(stamped && header.samples == x.Size() && header.base == base && header.fingerprint == Fingerprint(x, y)){
+                    return pyramid;
+                }
+            }
+            catch(const std::runtime_error&){}
+            Build(x, y, path, base, source);
+            return std::make_shared<const Pyramid>(path);
+        }
+        std::size_t Samples() const {return static_cast<std::size_t>(header_->samples);}
+        std::size_t Levels() const {return counts_.size();}
+        bool Sorted() const {return header_->sorted != 0;}
+        double XMin() const {return header_->x_min;}
+        double XMax() const {return header_->x_max;}
+        double YMin() const {return nodes_.back()[0].low;}
+        double YMax() const {return nodes_.back()[0].high;}
+        // Samples per node of a level; the last node of a level may hold fewer.
+        std::size_t Block(std::size_t level) const {return static_cast<std::size_t>(header_->base) << level;}
+        std::size_t Count(std::size_t level) const {return counts_[level];}
+        const Node* Nodes(std::size_t level) const {return nodes_[level];}
+        // Coarsest level whose blocks hold at most samples samples; false if even level 0 is coarser.
+        bool Level(std::size_t samples, std::size_t& level) const {
+            if(samples < header_->base){
+                return false;
+            }
+            level = 0;
+            while(level + 1 < counts_.size() && Block(level + 1) <= samples){
+                ++level;
+            }
+            return true;
+        }
+        // Calls f(px, py, n) with the nodes of level that cover samples [from, to), each as its
+        // first, low and high (in the order they came) and last point.
+        template<class F>
+        void Walk(std::size_t level, std::size_t from, std::size_t to, F&& f) const {
+            const std::size_t block = Block(level), end = std::min(counts_[level], (to + block - 1) / block);
+            const Node* nodes = nodes_[level];
+            double px[4 * chunk], py[4 * chunk];
+            for(std::size_t k = from / block; k < end; ){
+                std::size_t m = 0;
+                for(; k < end && m < 4 * chunk; ++k, m += 4){
+                    const Node& node = nodes[k];
+                    px[m] = node.x0, py[m] = node.first;
+                    px[m + 1] = px[m + 2] = (node.x0 + node.x1) / 2;
+                    py[m + 1] = node.order ? node.low : node.high, py[m + 2] = node.order ? node.high : node.low;
+                    px[m + 3] = node.x1, py[m + 3] = node.last;
+                }
+                f(static_cast<const double*>(px), static_cast<const double*>(py), m);
+            }
+        }
+    };
+};
@@ -0,0 +1,85 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+namespace Chartify{
+    // Bounded lock-free multi-producer, single-consumer queue (sequence-numbered slots).
+    // Push never blocks and never allocates: when the queue is full the item is dropped and
+    // counted, so producers can't be held up by a slow consumer. Pop is only called from the
+    // consumer thread and never waits for producers either.
+    template<class T>
+    class Queue{
+        static_assert(std::is_trivially_copyable<T>::value, "Queue items are copied between threads!");
+        static constexpr std::size_t line = 64;
+        struct Slot{
+            std::atomic<std::size_t> sequence;
+            T value;
+        };
+        std::unique_ptr<Slot[]> slots_;
+        const std::size_t mask_;
+        alignas(line) std::atomic<std::size_t> tail_{0};
+        alignas(line) std::atomic<std::uint64_t> dropped_{0};
+        alignas(line) std::size_t head_ = 0;
+        static std::size_t Round(std::size_t capacity){
+            std::size_t size = 2;
+            while(size < capacity){
+                size <<= 1;
+            }
+            return size;
+        }
+    public:
+        // Capacity is rounded up to a power of two.
+        explicit Queue(std::size_t capacity) : slots_(new Slot[Round(capacity)]), mask_(Round(capacity) - 1){
+            if(capacity == 0){
+                throw std::invalid_argument("Queue capacity must be positive!");
+            }
+            for(std::size_t i = 0; i <= mask_; ++i){
+                slots_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+        Queue(const Queue&) = delete;
+        Queue& operator=(const Queue&) = delete;
+        // Any thread. Returns false, and counts the item as dropped, when the queue is full.
+        bool Push(const T& value){
+            std::size_t at = tail_.load(std::memory_order_relaxed);
+            while(true){
+                Slot& slot = slots_[at & mask_];
+                std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+                std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(at);
+                if(diff == 0){
+                    if(tail_.compare_exchange_weak(at, at + 1, std::memory_order_relaxed)){
+                        slot.value = value;
+                        slot.sequence.store(at + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if(diff < 0){
+                    dropped_.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                else{
+                    at = tail_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+        // Consumer thread only. Returns false when nothing is ready.
+        bool Pop(T& value){
+            Slot& slot = slots_[head_ & mask_];
+            if(slot.sequence.load(std::memory_order_acquire) != head_ + 1){
+                return false;
+            }
+            value = slot.value;
+            slot.sequence.store(head_ + mask_ + 1, std::memory_order_release);
+            ++head_;
+            return true;
+        }
+        // Consumer thread only.
+        bool Empty() const {return slots_[head_ & mask_].sequence.load(std::memory_order_acquire) != head_ + 1;}
+        std::size_t Capacity() const {return mask_ + 1;}
+        std::uint64_t Dropped() const {return dropped_.load(std::memory_order_relaxed);}
+    };
+};
@@ -0,0 +1,381 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include "pool.h"
+#include "project.h"
+namespace Chartify{
+    // RGBA8 pixels a textured draw samples from, row by row.
+    struct Bitmap{
+        const sf::Uint8* pixels;
+        unsigned int width, height;
+    };
+    // CPU rasterizer for vertex arrays. Draw only records the call; Flush maps every primitive
+    // to pixels, bins it into the tiles its bounding box touches and rasterizes the tiles on the
+    // thread pool straight into the pixel buffer, so a frame costs O(primitives / workers) with
+    // no draw calls at all. Triangles are anti-aliased with 16-sample coverage masks that are
+    // merged per draw before blending, so the triangles of one stroke don't leave seams where
+    // they meet; lines are drawn with Wu's algorithm. Textured triangles sample their bitmap at
+    // pixel centres. Vertex colors are taken per primitive, and the vertices and bitmaps must
+    // stay unchanged until Flush; a bitmap is only read there, so it may be filled in late.
+    class Raster{
+        static constexpr int tile = 64;
+        static constexpr std::size_t min_chunk = 1 << 14;
+        // Pixel bounds, right and bottom exclusive.
+        struct Box{
+            int l, t, r, b;
+        };
+        struct Command{
+            const sf::Vertex* vertices;
+            sf::PrimitiveType type;
+            std::size_t first, last;
+            Affine affine;
+            Box clip;
+            const Bitmap* bitmap;
+        };
+        struct Scratch{
+            std::vector<std::uint16_t> mask;
+            std::vector<sf::Color> color;
+            Box dirty;
+        };
+        ThreadPool* pool_;
+        unsigned int width_ = 0, height_ = 0, columns_ = 0, rows_ = 0;
+        std::vector<sf::Uint8> pixels_;
+        sf::Color background_;
+        bool cleared = false;
+        std::vector<Command> commands_;
+        std::size_t primitives_ = 0;
+        std::vector<std::size_t> offsets_, starts_;
+        std::vector<std::uint32_t> entries_;
+        std::vector<Scratch> scratch_;
+        static std::size_t Primitives(sf::PrimitiveType type, std::size_t n){
+            switch(type){
+                case sf::Points: return n;
+                case sf::Lines: return n / 2;
+                case sf::LineStrip: return n > 1 ? n - 1 : 0;
+                case sf::Triangles: return n / 3;
+                case sf::TriangleStrip:
+                case sf::TriangleFan: return n > 2 ? n - 2 : 0;
+                default: throw std::invalid_argument("Raster doesn't draw quads!");
+            }
+        }
+        static int Bits(std::uint16_t x){
+            x = x - ((x >> 1) & 0x5555);
+            x = (x & 0x3333) + ((x >> 2) & 0x3333);
+            x = (x + (x >> 4)) & 0x0F0F;
+            return (x + (x >> 8)) & 0x1F;
+        }
+        static void Blend(sf::Uint8* d, const sf::Color& c, unsigned int a){
+            const unsigned int keep = 255 - a;
+            d[0] = static_cast<sf::Uint8>((c.r * a + d[0] * keep + 127) / 255);
+            d[1] = static_cast<sf::Uint8>((c.g * a + d[1] * keep + 127) / 255);
+            d[2] = static_cast<sf::Uint8>((c.b * a + d[2] * keep + 127) / 255);
+            d[3] = static_cast<sf::Uint8>(a + (d[3] * keep + 127) / 255);
+        }
+        // Vertices of primitive k of a command and their pixel positions; returns how many.
+        int Corners(const Command& c, std::size_t k, const sf::Vertex** v, sf::Vector2f* p) const {
+            const sf::Vertex* b = c.vertices;
+            int n = 3;
+            switch(c.type){
+                case sf::Points: v[0] = b + k, n = 1;
+                break;
+                case sf::Lines: v[0] = b + 2 * k, v[1] = b + 2 * k + 1, n = 2;
+                break;
+                case sf::LineStrip: v[0] = b + k, v[1] = b + k + 1, n = 2;
+                break;
+                case sf::Triangles: v[0] = b + 3 * k, v[1] = b + 3 * k + 1, v[2] = b + 3 * k + 2;
+                break;
+                case sf::TriangleStrip: v[0] = b + k, v[1] = b + k + 1, v[2] = b + k + 2;
+                break;
+                default: v[0] = b, v[1] = b + k + 1, v[2] = b + k + 2;
+                break;
+            }
+            for(int i = 0; i < n; ++i){
+                p[i] = sf::Vector2f(static_cast<float>(c.affine.ox + c.affine.sx * v[i]->position.x), static_cast<float>(c.affine.oy + c.affine.sy * v[i]->position.y));
+            }
+            return n;
+        }
+        // Pixels a primitive can touch within clip; Wu lines reach one pixel past their ends.
+        static Box Bounds(const sf::Vector2f* p, int n, const Box& clip){
+            float l = p[0].x, t = p[0].y, r = p[0].x, b = p[0].y;
+            for(int i = 1; i < n; ++i){
+                l = std::min(l, p[i].x), t = std::min(t, p[i].y), r = std::max(r, p[i].x), b = std::max(b, p[i].y);
+            }
+            const float slack = n == 2 ? 1.0f : 0.0f;
+            l = std::max(static_cast<float>(clip.l), std::floor(l) - slack), t = std::max(static_cast<float>(clip.t), std::floor(t) - slack);
+            r = std::min(static_cast<float>(clip.r), std::floor(r) + 1 + slack), b = std::min(static_cast<float>(clip.b), std::floor(b) + 1 + slack);
+            return Box{static_cast<int>(l), static_cast<int>(t), static_cast<int>(std::max(l, r)), static_cast<int>(std::max(t, b))};
+        }
+        // Calls f(primitive, tile) for every tile the primitives in [from, to) can touch.
+        template<class F>
+        void Bin(std::size_t from, std::size_t to, F&& f) const {
+            std::size_t c = 0;
+            while(commands_[c].last <= from){
+                ++c;
+            }
+            const sf::Vertex* v[3];
+            sf::Vector2f p[3];
+            for(std::size_t id = from; id < to; ++id){
+                while(commands_[c].last <= id){
+                    ++c;
+                }
+                const Command& command = commands_[c];
+                const Box b = Bounds(p, Corners(command, id - command.first, v, p), command.clip);
+                if(b.l >= b.r || b.t >= b.b){
+                    continue;
+                }
+                for(int ty = b.t / tile; ty <= (b.b - 1) / tile; ++ty){
+                    for(int tx = b.l / tile; tx <= (b.r - 1) / tile; ++tx){
+                        f(id, static_cast<std::size_t>(ty) * columns_ + tx);
+                    }
+                }
+            }
+        }
+        void Line(sf::Vector2f a, sf::Vector2f b, const sf::Color& color, const Box& box){
+            // Pixel centres sit on whole coordinates from here on.
+            float x0 = a.x - 0.5f, y0 = a.y - 0.5f, x1 = b.x - 0.5f, y1 = b.y - 0.5f;
+            const bool steep = std::abs(y1 - y0) > std::abs(x1 - x0);
+            if(steep){
+                std::swap(x0, y0), std::swap(x1, y1);
+            }
+            if(x0 > x1){
+                std::swap(x0, x1), std::swap(y0, y1);
+            }
+            const float gradient = x1 > x0 ? (y1 - y0) / (x1 - x0) : 0;
+            const int lo = steep ? box.t : box.l, hi = steep ? box.b : box.r, low = steep ? box.l : box.t, high = steep ? box.r : box.b;
+            const float to = std::max(static_cast<float>(lo), std::min(static_cast<float>(hi), std::ceil(x1))), from = std::min(to, std::max(static_cast<float>(lo), std::ceil(x0)));
+            for(int i = static_cast<int>(from); i < static_cast<int>(to); ++i){
+                const float y = y0 + gradient * (i - x0), base = std::floor(y);
+                if(base < low - 1 || base >= high){
+                    continue;
+                }
+                const int j = static_cast<int>(base);
+                const float f = y - base;
+                for(int k = 0; k < 2; ++k){
+                    const int m = j + k;
+                    const unsigned int alpha = static_cast<unsigned int>(color.a * (k ? f : 1 - f) + 0.5f);
+                    if(m >= low && m < high && alpha > 0){
+                        const int px = steep ? m : i, py = steep ? i : m;
+                        Blend(&pixels_[(static_cast<std::size_t>(py) * width_ + px) * 4], color, alpha);
+                    }
+                }
+            }
+        }
+        // Merges a triangle into the scratch coverage masks of the current draw.
+        void Cover(const sf::Vertex** v, sf::Vector2f* p, const Bitmap* bitmap, const Box& clip, const Box& tile_box, Scratch& s){
+            float area = (p[1].x - p[0].x) * (p[2].y - p[0].y) - (p[1].y - p[0].y) * (p[2].x - p[0].x);
+            if(area < 0){
+                std::swap(p[1], p[2]), std::swap(v[1], v[2]);
+                area = -area;
+            }
+            if(!(area > 0)){
+                return;
+            }
+            // Edge k runs from corner k to corner k + 1 and is positive inside.
+            float ea[3], eb[3], ec[3], er[3];
+            for(int k = 0; k < 3; ++k){
+                const sf::Vector2f& from = p[k];
+                const sf::Vector2f& to = p[(k + 1) % 3];
+                ea[k] = from.y - to.y, eb[k] = to.x - from.x;
+                ec[k] = -(ea[k] * from.x + eb[k] * from.y);
+                er[k] = 0.5f * (std::abs(ea[k]) + std::abs(eb[k]));
+            }
+            const Box b = Bounds(p, 3, clip);
+            if(b.l >= b.r || b.t >= b.b){
+                return;
+            }
+            s.dirty = Box{std::min(s.dirty.l, b.l), std::min(s.dirty.t, b.t), std::max(s.dirty.r, b.r), std::max(s.dirty.b, b.b)};
+            const sf::Color color = v[0]->color;
+            for(int y = b.t; y < b.b; ++y){
+                for(int x = b.l; x < b.r; ++x){
+                    const float cx = x + 0.5f, cy = y + 0.5f;
+                    float e[3];
+                    bool outside = false, inside = true;
+                    for(int k = 0; k < 3; ++k){
+                        e[k] = ea[k] * cx + eb[k] * cy + ec[k];
+                        outside |= e[k] < -er[k];
+                        inside &= e[k] >= er[k];
+                    }
+                    if(outside){
+                        continue;
+                    }
+                    const std::size_t at = static_cast<std::size_t>(y - tile_box.t) * tile + (x - tile_box.l);
+                    if(bitmap){
+                        if(e[0] < 0 || e[1] < 0 || e[2] < 0){
+                            continue;
+                        }
+                        // e[k] weighs the corner opposite edge k.
+                        const float w0 = e[1] / area, w1 = e[2] / area, w2 = e[0] / area;
+                        const float u = w0 * v[0]->texCoords.x + w1 * v[1]->texCoords.x + w2 * v[2]->texCoords.x;
+                        const float t = w0 * v[0]->texCoords.y + w1 * v[1]->texCoords.y + w2 * v[2]->texCoords.y;
+                        const unsigned int tx = static_cast<unsigned int>(std::min(static_cast<float>(bitmap->width - 1), std::max(0.0f, u)));
+                        const unsigned int ty = static_cast<unsigned int>(std::min(static_cast<float>(bitmap->height - 1), std::max(0.0f, t)));
+                        const sf::Uint8* texel = bitmap->pixels + (static_cast<std::size_t>(ty) * bitmap->width + tx) * 4;
+                        s.mask[at] = 0xFFFF;
+                        s.color[at] = sf::Color(color.r * texel[0] / 255, color.g * texel[1] / 255, color.b * texel[2] / 255, color.a * texel[3] / 255);
+                        continue;
+                    }
+                    std::uint16_t mask = 0xFFFF;
+                    if(!inside){
+                        for(int k = 0; k < 3; ++k){
+                            if(e[k] >= er[k]){
+                                continue;
+                            }
+                            // Samples sit at the centres of a 4 x 4 grid over the pixel.
+                            std::uint16_t in = 0;
+                            const float sx = 0.25f * ea[k], sy = 0.25f * eb[k];
+                            float row = e[k] - 1.5f * (sx + sy);
+                            for(int j = 0; j < 16; j += 4, row += sy){
+                                in |= static_cast<std::uint16_t>((row >= 0) | (row + sx >= 0) << 1 | (row + 2 * sx >= 0) << 2 | (row + 3 * sx >= 0) << 3) << j;
+                            }
+                            mask &= in;
+                        }
+                        if(mask == 0){
+                            continue;
+                        }
+                    }
+                    s.mask[at] |= mask;
+                    s.color[at] = color;
+                }
+            }
+        }
+        // Blends the coverage gathered for one draw and clears it.
+        void Resolve(Scratch& s, const Box& tile_box){
+            for(int y = s.dirty.t; y < s.dirty.b; ++y){
+                for(int x = s.dirty.l; x < s.dirty.r; ++x){
+                    const std::size_t at = static_cast<std::size_t>(y - tile_box.t) * tile + (x - tile_box.l);
+                    if(s.mask[at]){
+                        const unsigned int alpha = (s.color[at].a * Bits(s.mask[at]) + 8) / 16;
+                        if(alpha > 0){
+                            Blend(&pixels_[(static_cast<std::size_t>(y) * width_ + x) * 4], s.color[at], alpha);
+                        }
+                        s.mask[at] = 0;
+                    }
+                }
+            }
+            s.dirty = Box{tile_box.r, tile_box.b, tile_box.l, tile_box.t};
+        }
+        void Tile(std::size_t index, Scratch& s){
+            const int tx = static_cast<int>(index % columns_), ty = static_cast<int>(index / columns_);
+            const Box box{tx * tile, ty * tile, std::min<int>(width_, (tx + 1) * tile), std::min<int>(height_, (ty + 1) * tile)};
+            if(cleared){
+                for(int y = box.t; y < box.b; ++y){
+                    sf::Uint8* row = &pixels_[(static_cast<std::size_t>(y) * width_ + box.l) * 4];
+                    for(int x = box.l; x < box.r; ++x, row += 4){
+                        row[0] = background_.r, row[1] = background_.g, row[2] = background_.b, row[3] = background_.a;
+                    }
+                }
+            }
+            s.mask.resize(tile * tile), s.color.resize(tile * tile);
+            s.dirty = Box{box.r, box.b, box.l, box.t};
+            std::size_t c = 0;
+            bool pending = false;
+            const sf::Vertex* v[3];
+            sf::Vector2f p[3];
+            for(std::size_t e = starts_[index]; e < starts_[index + 1]; ++e){
+                const std::size_t id = entries_[e];
+                if(commands_[c].last <= id){
+                    if(pending){
+                        Resolve(s, box);
+                        pending = false;
+                    }
+                    while(commands_[c].last <= id){
+                        ++c;
+                    }
+                }
+                const Command& command = commands_[c];
+                if(command.bitmap && (!command.bitmap->pixels || command.bitmap->width == 0 || command.bitmap->height == 0)){
+                    continue;
+                }
+                const Box clip{std::max(box.l, command.clip.l), std::max(box.t, command.clip.t), std::min(box.r, command.clip.r), std::min(box.b, command.clip.b)};
+                const int n = Corners(command, id - command.first, v, p);
+                if(n == 3){
+                    Cover(v, p, command.bitmap, clip, box, s);
+                    pending = true;
+                }
+                else if(n == 2){
+                    Line(p[0], p[1], v[0]->color, clip);
+                }
+                else{
+                    const int x = static_cast<int>(std::floor(p[0].x)), y = static_cast<int>(std::floor(p[0].y));
+                    if(p[0].x >= clip.l && p[0].x < clip.r && p[0].y >= clip.t && p[0].y < clip.b){
+                        Blend(&pixels_[(static_cast<std::size_t>(y) * width_ + x) * 4], v[0]->color, v[0]->color.a);
+                    }
+                }
+            }
+            if(pending){
+                Resolve(s, box);
+            }
+        }
+    public:
+        explicit Raster(ThreadPool& pool = ThreadPool::Shared()) : pool_(&pool), scratch_(pool.Size()){}
+        void Resize(unsigned int width, unsigned int height){
+            width_ = width, height_ = height;
+            columns_ = (width + tile - 1) / tile, rows_ = (height + tile - 1) / tile;
+            pixels_.assign(static_cast<std::size_t>(width) * height * 4, 0);
+        }
+        // Drops what was drawn since the last Flush; the next Flush starts from color.
+        void Clear(const sf::Color& color){
+            background_ = color;
+            cleared = true;
+            commands_.clear();
+            primitives_ = 0;
+        }
+        // Records n vertices of type mapped to pixels by affine and clipped to clip. A textured
+        // draw gives the bitmap its texture coordinates are in, in pixels; it is read by Flush,
+        // and a bitmap that is still empty then is not drawn.
+        void Draw(const sf::Vertex* vertices, std::size_t n, sf::PrimitiveType type, const Affine& affine, const sf::IntRect& clip, const Bitmap* bitmap = nullptr){
+            const std::size_t count = Primitives(type, n);
+            Box box{std::max(0, clip.left), std::max(0, clip.top), std::min<int>(width_, clip.left + clip.width), std::min<int>(height_, clip.top + clip.height)};
+            if(count == 0 || box.l >= box.r || box.t >= box.b){
+                return;
+            }
+            if(primitives_ + count > std::numeric_limits<std::uint32_t>::max()){
+                throw std::length_error("Too many primitives for one frame!");
+            }
+            commands_.push_back(Command{vertices, type, primitives_, primitives_ + count, affine, box, bitmap});
+            primitives_ += count;
+        }
+        // Rasterizes everything drawn since Clear into the pixels.
+        void Flush(){
+            const std::size_t tiles = static_cast<std::size_t>(columns_) * rows_;
+            const std::size_t chunks = std::max<std::size_t>(1, std::min(4 * pool_->Size(), primitives_ / min_chunk));
+            const std::size_t step = (primitives_ + chunks - 1) / chunks;
+            offsets_.assign(chunks * tiles, 0);
+            starts_.assign(tiles + 1, 0);
+            if(primitives_ > 0){
+                pool_->For(chunks, [&](std::size_t c, std::size_t){
+                    std::size_t* count = &offsets_[c * tiles];
+                    Bin(c * step, std::min(primitives_, (c + 1) * step), [&](std::size_t, std::size_t t){++count[t];});
+                });
+                // Entries of a tile are grouped by chunk, so they stay in drawing order.
+                std::size_t total = 0;
+                for(std::size_t t = 0; t < tiles; ++t){
+                    starts_[t] = total;
+                    for(std::size_t c = 0; c < chunks; ++c){
+                        std::size_t n = offsets_[c * tiles + t];
+                        offsets_[c * tiles + t] = total;
+                        total += n;
+                    }
+                }
+                starts_[tiles] = total;
+                entries_.resize(total);
+                pool_->For(chunks, [&](std::size_t c, std::size_t){
+                    std::size_t* offset = &offsets_[c * tiles];
+                    Bin(c * step, std::min(primitives_, (c + 1) * step), [&](std::size_t id, std::size_t t){entries_[offset[t]++] = static_cast<std::uint32_t>(id);});
+                });
+            }
+            pool_->For(tiles, [&](std::size_t t, std::size_t worker){Tile(t, scratch_[worker]);});
+            cleared = false;
+            commands_.clear();
+            primitives_ = 0;
+        }
+        const sf::Uint8* Pixels() const {return pixels_.data();}
+        sf::Vector2u Size() const {return sf::Vector2u(width_, height_);}
+    };
+};
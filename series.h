@@ -0,0 +1,175 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+namespace Chartify{
+    struct Precision{
+        enum Type{
+            Double, Single
+        };
+    };
+    // One contiguous column of samples, either borrowed from the caller or owning a moved-in
+    // buffer. Copies of a column share the same storage, so configuring a chart never copies
+    // sample data.
+    class Column{
+        std::shared_ptr<const void> storage_;
+        const void* data_ = nullptr;
+        std::size_t size_ = 0;
+        Precision::Type precision_ = Precision::Double;
+        template<class T>
+        static Column Own(std::vector<T>&& data, Precision::Type precision){
+            auto owned = std::make_shared<std::vector<T>>(std::move(data));
+            Column c;
+            c.data_ = owned->data(), c.size_ = owned->size(), c.precision_ = precision;
+            c.storage_ = std::move(owned);
+            return c;
+        }
+    public:
+        Column() = default;
+        Column(std::vector<double>&& data) : Column(Own(std::move(data), Precision::Double)){}
+        Column(std::vector<float>&& data) : Column(Own(std::move(data), Precision::Single)){}
+        static Column View(const double* data, std::size_t size){
+            Column c;
+            c.data_ = data, c.size_ = size, c.precision_ = Precision::Double;
+            return c;
+        }
+        static Column View(const float* data, std::size_t size){
+            Column c;
+            c.data_ = data, c.size_ = size, c.precision_ = Precision::Single;
+            return c;
+        }
+        static Column View(const void* data, std::size_t size, Precision::Type precision, std::shared_ptr<const void> storage){
+            Column c;
+            c.data_ = data, c.size_ = size, c.precision_ = precision, c.storage_ = std::move(storage);
+            return c;
+        }
+        static Column Copy(const std::vector<double>& data, Precision::Type precision){
+            if(precision == Precision::Single){
+                return Column(std::vector<float>(data.begin(), data.end()));
+            }
+            return Column(std::vector<double>(data));
+        }
+        std::size_t Size() const {return size_;}
+        bool Empty() const {return size_ == 0;}
+        Precision::Type Type() const {return precision_;}
+        const void* Data() const {return data_;}
+        const std::shared_ptr<const void>& Storage() const {return storage_;}
+        double operator[](std::size_t i) const {
+            return precision_ == Precision::Single ? static_cast<const float*>(data_)[i] : static_cast<const double*>(data_)[i];
+        }
+        template<class F>
+        decltype(auto) Visit(F&& f) const {
+            if(precision_ == Precision::Single){
+                return f(static_cast<const float*>(data_));
+            }
+            return f(static_cast<const double*>(data_));
+        }
+    };
+    // Sliding-window extremum over a sequence of samples: a monotonic deque kept in a fixed
+    // circular buffer, so every push and eviction is amortized O(1) and never allocates.
+    template<class Compare>
+    class Extremum{
+        std::vector<std::pair<std::uint64_t, double>> items_;
+        std::size_t head_ = 0, size_ = 0;
+        Compare compare_;
+        std::pair<std::uint64_t, double>& At(std::size_t k){return items_[(head_ + k) % items_.size()];}
+    public:
+        explicit Extremum(std::size_t capacity) : items_(capacity){}
+        void Push(std::uint64_t sequence, double value){
+            while(size_ > 0 && !compare_(At(size_ - 1).second, value)){
+                --size_;
+            }
+            At(size_++) = std::make_pair(sequence, value);
+        }
+        void Evict(std::uint64_t oldest){
+            while(size_ > 0 && items_[head_].first < oldest){
+                head_ = (head_ + 1) % items_.size(), --size_;
+            }
+        }
+        bool Empty() const {return size_ == 0;}
+        double Value() const {return items_[head_].second;}
+    };
+    // Fixed-capacity ring of (x, y) samples for live series. Old samples are overwritten once
+    // the capacity is reached, and with a positive window only samples with
+    // x >= newest x - window stay visible. Bounds are maintained incrementally.
+    class Ring{
+        std::vector<double> x_, y_;
+        std::size_t start_ = 0, size_ = 0;
+        std::uint64_t next_ = 0;
+        double window_;
+        Extremum<std::less<double>> x_min_, y_min_;
+        Extremum<std::greater<double>> x_max_, y_max_;
+        void Drop(){
+            start_ = (start_ + 1) % x_.size(), --size_;
+        }
+    public:
+        Ring(std::size_t capacity, double window = 0) : x_(capacity), y_(capacity), window_(window), x_min_(capacity), y_min_(capacity), x_max_(capacity), y_max_(capacity){
+            if(capacity == 0){
+                throw std::invalid_argument("Ring capacity must be positive!");
+            }
+            if(window < 0){
+                throw std::invalid_argument("Window must not be negative!");
+            }
+        }
+        void Append(double x, double y){
+            if(size_ == x_.size()){
+                Drop();
+            }
+            std::size_t slot = (start_ + size_) % x_.size();
+            x_[slot] = x, y_[slot] = y;
+            ++size_;
+            if(window_ > 0){
+                while(size_ > 1 && x_[start_] < x - window_){
+                    Drop();
+                }
+            }
+            std::uint64_t oldest = next_ + 1 - size_;
+            x_min_.Evict(oldest), x_max_.Evict(oldest);
+            y_min_.Evict(oldest), y_max_.Evict(oldest);
+            x_min_.Push(next_, x), x_max_.Push(next_, x);
+            y_min_.Push(next_, y), y_max_.Push(next_, y);
+            ++next_;
+        }
+        void Append(const double* x, const double* y, std::size_t n){
+            for(std::size_t i = 0; i < n; ++i){
+                Append(x[i], y[i]);
+            }
+        }
+        std::size_t Size() const {return size_;}
+        std::size_t Capacity() const {return x_.size();}
+        double Window() const {return window_;}
+        double XMin() const {return x_min_.Value();}
+        double XMax() const {return x_max_.Value();}
+        double YMin() const {return y_min_.Value();}
+        double YMax() const {return y_max_.Value();}
+        // Calls f(x, y, n) for the (at most two) contiguous runs of samples, oldest first.
+        template<class F>
+        void Segments(F&& f) const {
+            std::size_t first = std::min(size_, x_.size() - start_);
+            if(first > 0){
+                f(x_.data() + start_, y_.data() + start_, first);
+            }
+            if(size_ > first){
+                f(x_.data(), y_.data(), size_ - first);
+            }
+        }
+    };
+    // One point addressed to a stream series, as passed through a Canvas feed.
+    struct Sample{
+        std::size_t series;
+        double x, y;
+    };
+    template<class F>
+    decltype(auto) Visit(const Column& x, const Column& y, F&& f){
+        return x.Visit([&](auto px){
+            return y.Visit([&](auto py){
+                return f(px, py);
+            });
+        });
+    }
+};
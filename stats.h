@@ -0,0 +1,164 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <ostream>
+#include <string>
+#include <vector>
+namespace Chartify{
+    // Heap allocations made by the calling thread. Only counted when CHARTIFY_COUNT_ALLOCATIONS is
+    // defined in exactly one translation unit before this header is included; otherwise it stays 0.
+    inline std::size_t& Allocations(){
+        thread_local std::size_t count = 0;
+        return count;
+    }
+    struct Stage{
+        enum Type{
+            Bounds, Projection, Stroke, Grid, Labels, Title, Present, Count
+        };
+        static const char* Name(Type stage){
+            static const char* names[Count] = {"bounds", "projection", "stroke", "grid", "labels", "title", "present"};
+            return names[stage];
+        }
+    };
+    struct Frame{
+        double stage[Stage::Count] = {};
+        double total = 0;
+        std::size_t draws = 0, vertices = 0, allocations = 0;
+    };
+    // Per-frame profiling: stage timers, draw/vertex/allocation counts and a frame-time histogram
+    // over the last Window() frames. While disabled, Begin/End/Scope only test a flag.
+    class Stats{
+        typedef std::chrono::steady_clock clock;
+        static constexpr std::size_t window_ = 240;
+        static constexpr std::size_t buckets_ = 12;
+        bool enabled_ = false;
+        Frame current_, last_;
+        std::size_t frames_ = 0, allocations_ = 0, head_ = 0;
+        clock::time_point start_;
+        std::vector<double> times_;
+        std::array<std::size_t, buckets_> histogram_{};
+        static double Ms(clock::time_point from){
+            return std::chrono::duration<double, std::milli>(clock::now() - from).count();
+        }
+        static std::size_t Bucket(double ms){
+            if(ms < Edge(1)){
+                return 0;
+            }
+            return std::min<std::size_t>(buckets_ - 1, static_cast<std::size_t>(std::log2(ms) + 2));
+        }
+    public:
+        class Scope{
+            Stats* stats_;
+            Stage::Type stage_;
+            clock::time_point start_;
+        public:
+            Scope(Stats& stats, Stage::Type stage) : stats_(stats.enabled_ ? &stats : nullptr), stage_(stage){
+                if(stats_){
+                    start_ = clock::now();
+                }
+            }
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+            ~Scope(){
+                if(stats_){
+                    stats_->current_.stage[stage_] += Ms(start_);
+                }
+            }
+        };
+        void Enable(bool enabled){
+            enabled_ = enabled;
+            if(enabled){
+                times_.reserve(window_);
+            }
+        }
+        bool Enabled() const {return enabled_;}
+        void Begin(){
+            if(enabled_){
+                current_ = Frame();
+                allocations_ = Allocations();
+                start_ = clock::now();
+            }
+        }
+        void End(std::size_t draws, std::size_t vertices){
+            if(!enabled_){
+                return;
+            }
+            current_.total = Ms(start_);
+            current_.draws = draws, current_.vertices = vertices;
+            current_.allocations = Allocations() - allocations_;
+            last_ = current_;
+            if(times_.size() < window_){
+                times_.push_back(last_.total);
+            }
+            else{
+                --histogram_[Bucket(times_[head_])];
+                times_[head_] = last_.total;
+                head_ = (head_ + 1) % window_;
+            }
+            ++histogram_[Bucket(last_.total)];
+            ++frames_;
+        }
+        void Reset(){
+            current_ = last_ = Frame();
+            frames_ = head_ = 0;
+            times_.clear();
+            histogram_.fill(0);
+        }
+        const Frame& Last() const {return last_;}
+        std::size_t Frames() const {return frames_;}
+        static std::size_t Window(){return window_;}
+        // Bucket k counts recent frames taking [Edge(k), Edge(k + 1)) ms; the last bucket is open.
+        const std::array<std::size_t, buckets_>& Histogram() const {return histogram_;}
+        static double Edge(std::size_t k){return k == 0 ? 0 : std::ldexp(0.5, static_cast<int>(k) - 1);}
+        double Mean() const {
+            double sum = 0;
+            for(double t : times_){
+                sum += t;
+            }
+            return times_.empty() ? 0 : sum / times_.size();
+        }
+        // Writes a short summary of the last frame into out without allocating.
+        void Text(char* out, std::size_t size) const {
+            std::snprintf(out, size, "frame %.2f ms (avg %.2f)\ndraws %zu  verts %zu  allocs %zu", last_.total, Mean(), last_.draws, last_.vertices, last_.allocations);
+        }
+        std::string Text() const {
+            char line[160];
+            Text(line, sizeof(line));
+            return line;
+        }
+        void Json(std::ostream& out) const {
+            out << "{\"frames\": " << frames_ << ", \"mean_ms\": " << Mean() << ", \"last\": {\"total_ms\": " << last_.total;
+            for(std::size_t s = 0; s < Stage::Count; ++s){
+                out << ", \"" << Stage::Name(static_cast<Stage::Type>(s)) << "_ms\": " << last_.stage[s];
+            }
+            out << ", \"draw_calls\": " << last_.draws << ", \"vertices\": " << last_.vertices << ", \"allocations\": " << last_.allocations << "}, \"histogram\": [";
+            for(std::size_t k = 0; k < buckets_; ++k){
+                out << (k ? ", " : "") << "{\"from_ms\": " << Edge(k) << ", \"count\": " << histogram_[k] << "}";
+            }
+            out << "]}";
+        }
+    };
+};
+#if defined(CHARTIFY_COUNT_ALLOCATIONS)
+// Kept out of line so the compiler can't pair the inlined malloc/free with new/delete calls.
+#if defined(__GNUC__)
+#define CHARTIFY_NOINLINE __attribute__((noinline))
+#else
+#define CHARTIFY_NOINLINE
+#endif
+CHARTIFY_NOINLINE void* operator new(std::size_t size){
+    ++Chartify::Allocations();
+    if(void* p = std::malloc(size ? size : 1)){
+        return p;
+    }
+    throw std::bad_alloc();
+}
+CHARTIFY_NOINLINE void operator delete(void* p) noexcept {std::free(p);}
+CHARTIFY_NOINLINE void operator delete(void* p, std::size_t) noexcept {std::free(p);}
+#endif
@@ -0,0 +1,244 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+namespace Chartify{
+    struct Cap{
+        enum Type{
+            Butt, Round
+        };
+    };
+    // Line styles are compile-time policies with three constexpr members:
+    //   width    line width, or dot diameter, in pixels;
+    //   cap      Cap::Butt draws the "on" runs of pattern as quads with bevel joins, Cap::Round
+    //            draws one dot at the start of every pattern period;
+    //   pattern  std::array of alternating on/off lengths in pixels, empty for a solid line.
+    // Any struct with these members can be passed to Stroke::Build, e.g. a dash-dot line:
+    //   struct DashDot{
+    //       static constexpr float width = 2;
+    //       static constexpr Cap::Type cap = Cap::Butt;
+    //       static constexpr std::array<float, 4> pattern = {12, 4, 2, 4};
+    //   };
+    namespace Style{
+        struct Solid{
+            static constexpr float width = 2;
+            static constexpr Cap::Type cap = Cap::Butt;
+            static constexpr std::array<float, 0> pattern = {};
+        };
+        struct Dashed{
+            static constexpr float width = 2;
+            static constexpr Cap::Type cap = Cap::Butt;
+            static constexpr std::array<float, 2> pattern = {10, 5};
+        };
+        struct Dotted{
+            static constexpr float width = 4;
+            static constexpr Cap::Type cap = Cap::Round;
+            static constexpr std::array<float, 1> pattern = {7};
+        };
+    };
+    // Builds the geometry of a whole polyline into one sf::Triangles vertex array,
+    // so every series is submitted with a single draw call.
+    class Stroke{
+        static constexpr std::size_t round_ = 8;
+        static sf::Vector2f Normal(const sf::Vector2f& d, float half){return sf::Vector2f(-d.y * half, d.x * half);}
+        static void Quad(sf::VertexArray& out, const sf::Vector2f& a, const sf::Vector2f& b, const sf::Vector2f& n, const sf::Color& color){
+            out.append(sf::Vertex(a + n, color)), out.append(sf::Vertex(a - n, color)), out.append(sf::Vertex(b + n, color));
+            out.append(sf::Vertex(b + n, color)), out.append(sf::Vertex(a - n, color)), out.append(sf::Vertex(b - n, color));
+        }
+        static void Join(sf::VertexArray& out, const sf::Vector2f& p, const sf::Vector2f& n0, const sf::Vector2f& n1, const sf::Color& color){
+            out.append(sf::Vertex(p, color)), out.append(sf::Vertex(p + n0, color)), out.append(sf::Vertex(p + n1, color));
+            out.append(sf::Vertex(p, color)), out.append(sf::Vertex(p - n0, color)), out.append(sf::Vertex(p - n1, color));
+        }
+        static const sf::Vector2f* Circle(){
+            static const struct Table{
+                sf::Vector2f p[round_ + 1];
+                Table(){
+                    for(std::size_t k = 0; k <= round_; ++k){
+                        float a = 2 * 3.14159265f * k / round_;
+                        p[k] = sf::Vector2f(std::cos(a), std::sin(a));
+                    }
+                }
+            } table;
+            return table.p;
+        }
+        static void Dot(sf::VertexArray& out, const sf::Vector2f& p, float R, const sf::Color& color){
+            const sf::Vector2f* circle = Circle();
+            for(std::size_t k = 0; k < round_; ++k){
+                out.append(sf::Vertex(p, color));
+                out.append(sf::Vertex(p + circle[k] * R, color));
+                out.append(sf::Vertex(p + circle[k + 1] * R, color));
+            }
+        }
+        static float Length(const sf::Vector2f& d){return std::sqrt(d.x * d.x + d.y * d.y);}
+        template<std::size_t N>
+        static constexpr float Period(const std::array<float, N>& pattern){
+            float sum = 0;
+            for(std::size_t k = 0; k < N; ++k){
+                sum += pattern[k];
+            }
+            return sum;
+        }
+        // Where a pattern of the given period starts, with phase pixels of it already covered.
+        static float Phase(double phase, float period){
+            double p = std::fmod(phase, static_cast<double>(period));
+            return static_cast<float>(p < 0 ? p + period : p);
+        }
+        // Liang-Barsky: the part [t0, t1] of the segment a + d * t, t in [0, len], inside r.
+        static bool Cull(const sf::FloatRect* r, const sf::Vector2f& a, const sf::Vector2f& d, float len, float& t0, float& t1){
+            t0 = 0, t1 = len;
+            if(!r){
+                return true;
+            }
+            auto edge = [&](float p, float q){
+                if(p == 0){
+                    return q >= 0;
+                }
+                float t = q / p;
+                if(p < 0){
+                    t0 = std::max(t0, t);
+                }
+                else{
+                    t1 = std::min(t1, t);
+                }
+                return t0 < t1;
+            };
+            return edge(-d.x, a.x - r->left) && edge(d.x, r->left + r->width - a.x) && edge(-d.y, a.y - r->top) && edge(d.y, r->top + r->height - a.y);
+        }
+    public:
+        typedef void (*Painter)(const sf::Vertex*, std::size_t, const sf::Color&, sf::VertexArray&, const sf::FloatRect*, double);
+        // Strokes the polyline c[0..n) in Style, starting phase pixels into the pattern. With a
+        // clip rect, geometry is only emitted for segments that cross it and the pattern still
+        // advances over the culled parts. A caller that draws a slice of a longer line passes
+        // a phase anchored to the line's start to keep the pattern from restarting at the
+        // slice. The style is fixed at compile time: pattern lengths, period and width are
+        // constants and the loop has no per-segment style branches.
+        template<class S>
+        static void Build(const sf::Vertex* c, std::size_t n, const sf::Color& color, sf::VertexArray& out, const sf::FloatRect* clip = nullptr, double phase = 0){
+            constexpr std::size_t count = std::tuple_size<decltype(S::pattern)>::value;
+            constexpr float half = S::width / 2;
+            out.setPrimitiveType(sf::Triangles);
+            if constexpr(S::cap == Cap::Round){
+                static_assert(count > 0 && Period(S::pattern) > 0, "Round caps need a positive pattern period!");
+                constexpr float spacing = Period(S::pattern);
+                // Distance from the start of the current segment to the next dot.
+                float next = Phase(phase, spacing);
+                next = next > 0 ? spacing - next : 0;
+                for(std::size_t i = 1; i < n; ++i){
+                    const sf::Vector2f& iu = c[i - 1].position, iv = c[i].position;
+                    sf::Vector2f div = iv - iu;
+                    float segment_len = Length(div), t0, t1;
+                    if(segment_len == 0){
+                        continue;
+                    }
+                    div /= segment_len;
+                    if(Cull(clip, iu, div, segment_len, t0, t1)){
+                        if(next < t0){
+                            next += std::ceil((t0 - next) / spacing) * spacing;
+                        }
+                        for(; next < t1; next += spacing){
+                            Dot(out, iu + div * next, half, color);
+                        }
+                    }
+                    if(next < segment_len){
+                        next += std::ceil((segment_len - next) / spacing) * spacing;
+                    }
+                    next -= segment_len;
+                }
+            }
+            else if constexpr(count == 0){
+                sf::Vector2f prev;
+                bool joined = false;
+                for(std::size_t i = 1; i < n; ++i){
+                    const sf::Vector2f& iu = c[i - 1].position, iv = c[i].position;
+                    sf::Vector2f div = iv - iu;
+                    float segment_len = Length(div), t0, t1;
+                    if(segment_len == 0){
+                        continue;
+                    }
+                    div /= segment_len;
+                    if(!Cull(clip, iu, div, segment_len, t0, t1)){
+                        joined = false;
+                        continue;
+                    }
+                    sf::Vector2f normal = Normal(div, half);
+                    if(joined){
+                        Join(out, iu, prev, normal, color);
+                    }
+                    Quad(out, iu, iv, normal, color);
+                    prev = normal;
+                    joined = true;
+                }
+            }
+            else{
+                static_assert(count % 2 == 0 && Period(S::pattern) > 0, "Dash patterns need on/off pairs and a positive period!");
+                constexpr float period = Period(S::pattern);
+                // Current pattern entry (even entries are drawn) and what is left of it.
+                std::size_t k = 0;
+                float left = S::pattern[0];
+                auto advance = [&](float d){
+                    d = std::fmod(d, period);
+                    while(d >= left){
+                        d -= left;
+                        k = (k + 1) % count;
+                        left = S::pattern[k];
+                    }
+                    left -= d;
+                };
+                advance(Phase(phase, period));
+                sf::Vector2f prev;
+                bool joined = false;
+                for(std::size_t i = 1; i < n; ++i){
+                    const sf::Vector2f& iu = c[i - 1].position, iv = c[i].position;
+                    sf::Vector2f div = iv - iu;
+                    float segment_len = Length(div), t0, t1;
+                    if(segment_len == 0){
+                        continue;
+                    }
+                    div /= segment_len;
+                    if(!Cull(clip, iu, div, segment_len, t0, t1)){
+                        advance(segment_len);
+                        joined = false;
+                        continue;
+                    }
+                    sf::Vector2f normal = Normal(div, half);
+                    if(t0 > 0){
+                        advance(t0);
+                    }
+                    if(joined && t0 == 0 && k % 2 == 0){
+                        Join(out, iu, prev, normal, color);
+                    }
+                    for(float drawn = t0; drawn < t1; ){
+                        float current_step = std::min(left, t1 - drawn);
+                        if(k % 2 == 0){
+                            Quad(out, iu + div * drawn, iu + div * (drawn + current_step), normal, color);
+                        }
+                        drawn += current_step;
+                        left -= current_step;
+                        if(left <= 0){
+                            k = (k + 1) % count;
+                            left = S::pattern[k];
+                        }
+                    }
+                    if(t1 < segment_len){
+                        advance(segment_len - t1);
+                    }
+                    prev = normal;
+                    joined = t1 == segment_len;
+                }
+            }
+        }
+        template<class S>
+        static Painter Of(){return &Build<S>;}
+        static void Solid(const sf::Vertex* c, std::size_t n, const sf::Color& color, sf::VertexArray& out, const sf::FloatRect* clip = nullptr, double phase = 0){
+            Build<Style::Solid>(c, n, color, out, clip, phase);
+        }
+        static void Dashed(const sf::Vertex* c, std::size_t n, const sf::Color& color, sf::VertexArray& out, const sf::FloatRect* clip = nullptr, double phase = 0){
+            Build<Style::Dashed>(c, n, color, out, clip, phase);
+        }
+        static void Dotted(const sf::Vertex* c, std::size_t n, const sf::Color& color, sf::VertexArray& out, const sf::FloatRect* clip = nullptr, double phase = 0){
+            Build<Style::Dotted>(c, n, color, out, clip, phase);
+        }
+    };
+};
@@ -0,0 +1,426 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "marker.h"
+namespace Chartify{
+    // Polyline simplification for export. A radial pass first drops points closer than the
+    // tolerance to the last kept one, then Ramer–Douglas–Peucker removes every point that lies
+    // within the tolerance of the chord between the points kept around it. The recursion runs
+    // on an explicit stack, and all scratch is kept between calls.
+    class Simplifier{
+        static constexpr std::size_t span_limit = 256;
+        std::vector<sf::Vector2f> points_, out_;
+        std::vector<std::pair<std::size_t, std::size_t>> stack_;
+        std::vector<char> keep_;
+        static float Distance(const sf::Vector2f& p, const sf::Vector2f& a, const sf::Vector2f& b){
+            sf::Vector2f d = b - a, e = p - a;
+            float length = d.x * d.x + d.y * d.y;
+            if(length == 0){
+                return std::sqrt(e.x * e.x + e.y * e.y);
+            }
+            return std::abs(d.x * e.y - d.y * e.x) / std::sqrt(length);
+        }
+    public:
+        const std::vector<sf::Vector2f>& Run(const sf::Vertex* c, std::size_t n, float tolerance){
+            points_.clear(), out_.clear();
+            for(std::size_t i = 0; i < n; ++i){
+                const sf::Vector2f& p = c[i].position;
+                if(points_.empty() || i + 1 == n){
+                    points_.push_back(p);
+                    continue;
+                }
+                sf::Vector2f d = p - points_.back();
+                if(d.x * d.x + d.y * d.y >= tolerance * tolerance){
+                    points_.push_back(p);
+                }
+            }
+            const std::size_t m = points_.size();
+            if(m < 3){
+                out_ = points_;
+                return out_;
+            }
+            // Spans start at most span_limit points long, which bounds the worst case (noise,
+            // unsorted data) to O(n * span_limit) at the cost of one kept point per span.
+            keep_.assign(m, 0);
+            stack_.clear();
+            for(std::size_t k = 0; k + 1 < m; k += span_limit){
+                std::size_t to = std::min(m - 1, k + span_limit);
+                keep_[k] = keep_[to] = 1;
+                stack_.emplace_back(k, to);
+            }
+            while(!stack_.empty()){
+                std::pair<std::size_t, std::size_t> span = stack_.back();
+                stack_.pop_back();
+                float worst = 0;
+                std::size_t at = span.first;
+                for(std::size_t k = span.first + 1; k < span.second; ++k){
+                    float d = Distance(points_[k], points_[span.first], points_[span.second]);
+                    if(d > worst){
+                        worst = d, at = k;
+                    }
+                }
+                if(worst > tolerance){
+                    keep_[at] = 1;
+                    stack_.emplace_back(span.first, at);
+                    stack_.emplace_back(at, span.second);
+                }
+            }
+            for(std::size_t k = 0; k < m; ++k){
+                if(keep_[k]){
+                    out_.push_back(points_[k]);
+                }
+            }
+            return out_;
+        }
+    };
+    // Streams a chart to a vector format through a 64 KB write buffer. Coordinates are canvas
+    // pixels with y growing downwards, as on screen.
+    class VectorWriter{
+        std::FILE* file_;
+        std::string path_;
+        std::vector<char> buffer_;
+        std::size_t used_ = 0, flushed_ = 0;
+    protected:
+        void Flush(){
+            if(used_ > 0 && std::fwrite(buffer_.data(), 1, used_, file_) != used_){
+                throw std::runtime_error("Failed to write " + path_);
+            }
+            flushed_ += used_, used_ = 0;
+        }
+        void Put(const char* text, std::size_t n){
+            if(used_ + n > buffer_.size()){
+                Flush();
+                if(n > buffer_.size()){
+                    flushed_ += n;
+                    if(std::fwrite(text, 1, n, file_) != n){
+                        throw std::runtime_error("Failed to write " + path_);
+                    }
+                    return;
+                }
+            }
+            std::copy(text, text + n, buffer_.data() + used_);
+            used_ += n;
+        }
+        void Put(const char* text){Put(text, std::char_traits<char>::length(text));}
+        void Format(const char* format, ...){
+            char line[256];
+            va_list args;
+            va_start(args, format);
+            int n = std::vsnprintf(line, sizeof(line), format, args);
+            va_end(args);
+            Put(line, std::min<std::size_t>(n, sizeof(line) - 1));
+        }
+        // Bytes written so far, for formats that index their own offsets.
+        std::size_t Offset() const {return flushed_ + used_;}
+    public:
+        explicit VectorWriter(const std::string& path) : file_(std::fopen(path.c_str(), "wb")), path_(path), buffer_(1 << 16){
+            if(!file_){
+                throw std::runtime_error("Failed to open " + path);
+            }
+        }
+        VectorWriter(const VectorWriter&) = delete;
+        VectorWriter& operator=(const VectorWriter&) = delete;
+        virtual void Begin(unsigned int width, unsigned int height, const sf::Color& background) = 0;
+        // Everything until Unclip() is clipped to area.
+        virtual void Clip(const sf::FloatRect& area) = 0;
+        virtual void Unclip() = 0;
+        // dash holds on/off lengths in pixels, none for a solid line; round caps turn zero-length
+        // dashes into dots.
+        virtual void Polyline(const sf::Vector2f* p, std::size_t n, const sf::Color& color, float width, const std::vector<float>& dash, bool round) = 0;
+        // Independent segments, two vertices each, as in an sf::Lines array.
+        virtual void Lines(const sf::Vertex* v, std::size_t n, const sf::Color& color, float width) = 0;
+        virtual void Markers(const sf::Vector2f* c, std::size_t n, Marker::Shape shape, float size, const sf::Color& color) = 0;
+        // position is the left end of the baseline.
+        virtual void Text(const sf::String& text, sf::Vector2f position, float size, const sf::Color& color) = 0;
+        virtual void End() = 0;
+        // Flushes and closes the file; throws if any of it failed to reach the disk.
+        void Close(){
+            if(!file_){
+                return;
+            }
+            Flush();
+            bool failed = std::fclose(file_) != 0;
+            file_ = nullptr;
+            if(failed){
+                throw std::runtime_error("Failed to write " + path_);
+            }
+        }
+        virtual ~VectorWriter(){
+            if(file_){
+                std::fclose(file_);
+            }
+        }
+        // SVG for paths ending in ".svg", PDF for ".pdf".
+        static std::unique_ptr<VectorWriter> Open(const std::string& path);
+    };
+    class SvgWriter : public VectorWriter{
+        void Paint(const char* attribute, const sf::Color& color){
+            Format(" %s=\"#%02x%02x%02x\"", attribute, color.r, color.g, color.b);
+            if(color.a != 255){
+                Format(" %s-opacity=\"%.3f\"", attribute, color.a / 255.0);
+            }
+        }
+        void Utf8(sf::Uint32 c){
+            char out[4];
+            std::size_t n = 0;
+            if(c < 0x80){
+                out[n++] = static_cast<char>(c);
+            }
+            else if(c < 0x800){
+                out[n++] = static_cast<char>(0xC0 | (c >> 6)), out[n++] = static_cast<char>(0x80 | (c & 0x3F));
+            }
+            else if(c < 0x10000){
+                out[n++] = static_cast<char>(0xE0 | (c >> 12)), out[n++] = static_cast<char>(0x80 | ((c >> 6) & 0x3F)), out[n++] = static_cast<char>(0x80 | (c & 0x3F));
+            }
+            else{
+                out[n++] = static_cast<char>(0xF0 | (c >> 18)), out[n++] = static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+                out[n++] = static_cast<char>(0x80 | ((c >> 6) & 0x3F)), out[n++] = static_cast<char>(0x80 | (c & 0x3F));
+            }
+            Put(out, n);
+        }
+        std::size_t clips_ = 0;
+    public:
+        using VectorWriter::VectorWriter;
+        void Begin(unsigned int width, unsigned int height, const sf::Color& background) override {
+            Format("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"%u\" height=\"%u\" viewBox=\"0 0 %u %u\">\n", width, height, width, height);
+            Format("<rect width=\"%u\" height=\"%u\"", width, height);
+            Paint("fill", background);
+            Put("/>\n");
+        }
+        void Clip(const sf::FloatRect& area) override {
+            ++clips_;
+            Format("<clipPath id=\"c%zu\"><rect x=\"%.2f\" y=\"%.2f\" width=\"%.2f\" height=\"%.2f\"/></clipPath>\n<g clip-path=\"url(#c%zu)\">\n", clips_, area.left, area.top, area.width, area.height, clips_);
+        }
+        void Unclip() override {Put("</g>\n");}
+        void Polyline(const sf::Vector2f* p, std::size_t n, const sf::Color& color, float width, const std::vector<float>& dash, bool round) override {
+            if(n < 2){
+                return;
+            }
+            Put("<polyline fill=\"none\"");
+            Paint("stroke", color);
+            Format(" stroke-width=\"%g\" stroke-linejoin=\"bevel\"", width);
+            if(round){
+                Put(" stroke-linecap=\"round\"");
+            }
+            if(!dash.empty()){
+                Put(" stroke-dasharray=\"");
+                for(std::size_t k = 0; k < dash.size(); ++k){
+                    Format(k ? " %g" : "%g", dash[k]);
+                }
+                Put("\"");
+            }
+            Put(" points=\"");
+            for(std::size_t i = 0; i < n; ++i){
+                Format(i ? " %.2f,%.2f" : "%.2f,%.2f", p[i].x, p[i].y);
+            }
+            Put("\"/>\n");
+        }
+        void Lines(const sf::Vertex* v, std::size_t n, const sf::Color& color, float width) override {
+            if(n < 2){
+                return;
+            }
+            Put("<path fill=\"none\"");
+            Paint("stroke", color);
+            Format(" stroke-width=\"%g\" d=\"", width);
+            for(std::size_t i = 0; i + 1 < n; i += 2){
+                Format("M%.2f %.2fL%.2f %.2f", v[i].position.x, v[i].position.y, v[i + 1].position.x, v[i + 1].position.y);
+            }
+            Put("\"/>\n");
+        }
+        void Markers(const sf::Vector2f* c, std::size_t n, Marker::Shape shape, float size, const sf::Color& color) override {
+            if(n == 0){
+                return;
+            }
+            const float h = shape == Marker::Point ? 0.5f : size / 2;
+            Put("<path");
+            if(shape == Marker::Cross){
+                Put(" fill=\"none\"");
+                Paint("stroke", color);
+                Format(" stroke-width=\"%g\"", size / 4);
+            }
+            else{
+                Paint("fill", color);
+            }
+            Put(" d=\"");
+            for(std::size_t i = 0; i < n; ++i){
+                switch(shape){
+                    case Marker::Point:
+                    case Marker::Square: Format("M%.2f %.2fh%gv%gh%gz", c[i].x - h, c[i].y - h, 2 * h, 2 * h, -2 * h);
+                    break;
+                    case Marker::Circle: Format("M%.2f %.2fa%g %g 0 1 0 %g 0a%g %g 0 1 0 %g 0z", c[i].x - h, c[i].y, h, h, 2 * h, h, h, -2 * h);
+                    break;
+                    case Marker::Cross: Format("M%.2f %.2fh%gM%.2f %.2fv%g", c[i].x - h, c[i].y, 2 * h, c[i].x, c[i].y - h, 2 * h);
+                    break;
+                }
+            }
+            Put("\"/>\n");
+        }
+        void Text(const sf::String& text, sf::Vector2f position, float size, const sf::Color& color) override {
+            Format("<text x=\"%.2f\" y=\"%.2f\" font-family=\"sans-serif\" font-size=\"%g\"", position.x, position.y, size);
+            Paint("fill", color);
+            Put(" xml:space=\"preserve\">");
+            for(sf::Uint32 c : text){
+                switch(c){
+                    case '&': Put("&amp;");
+                    break;
+                    case '<': Put("&lt;");
+                    break;
+                    case '>': Put("&gt;");
+                    break;
+                    default: Utf8(c);
+                }
+            }
+            Put("</text>\n");
+        }
+        void End() override {Put("</svg>\n");}
+    };
+    // Single-page PDF with the base-14 Helvetica font. The content stream is written as it is
+    // produced; its length and the cross-reference table follow it at the end. Text outside
+    // Latin-1 is written as '?', and colors are opaque.
+    class PdfWriter : public VectorWriter{
+        std::size_t objects_[7] = {};
+        std::size_t start_ = 0;
+        void Object(int id){
+            objects_[id] = Offset();
+            Format("%d 0 obj\n", id);
+        }
+        void Stroke(const sf::Color& color, float width){
+            Format("%.3f %.3f %.3f RG %g w\n", color.r / 255.0, color.g / 255.0, color.b / 255.0, width);
+        }
+        void Fill(const sf::Color& color){
+            Format("%.3f %.3f %.3f rg\n", color.r / 255.0, color.g / 255.0, color.b / 255.0);
+        }
+    public:
+        using VectorWriter::VectorWriter;
+        void Begin(unsigned int width, unsigned int height, const sf::Color& background) override {
+            Put("%PDF-1.4\n");
+            Object(1);
+            Put("<< /Type /Catalog /Pages 2 0 R >>\nendobj\n");
+            Object(2);
+            Put("<< /Type /Pages /Kids [3 0 R] /Count 1 >>\nendobj\n");
+            Object(3);
+            Format("<< /Type /Page /Parent 2 0 R /MediaBox [0 0 %u %u] /Contents 4 0 R /Resources << /Font << /F1 5 0 R >> >> >>\nendobj\n", width, height);
+            Object(5);
+            Put("<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica /Encoding /WinAnsiEncoding >>\nendobj\n");
+            Object(4);
+            Put("<< /Length 6 0 R >>\nstream\n");
+            start_ = Offset();
+            // Flip to canvas coordinates: origin top-left, y down.
+            Format("1 0 0 -1 0 %u cm 1 J 2 j\n", height);
+            Fill(background);
+            Format("0 0 %u %u re f\n", width, height);
+        }
+        void Clip(const sf::FloatRect& area) override {
+            Format("q %.2f %.2f %.2f %.2f re W n\n", area.left, area.top, area.width, area.height);
+        }
+        void Unclip() override {Put("Q\n");}
+        void Polyline(const sf::Vector2f* p, std::size_t n, const sf::Color& color, float width, const std::vector<float>& dash, bool round) override {
+            if(n < 2){
+                return;
+            }
+            Put("q ");
+            Stroke(color, width);
+            Put(round ? "1 J\n" : "0 J\n");
+            if(!dash.empty()){
+                Put("[");
+                for(std::size_t k = 0; k < dash.size(); ++k){
+                    Format(k ? " %g" : "%g", dash[k]);
+                }
+                Put("] 0 d\n");
+            }
+            for(std::size_t i = 0; i < n; ++i){
+                Format(i ? "%.2f %.2f l\n" : "%.2f %.2f m\n", p[i].x, p[i].y);
+            }
+            Put("S Q\n");
+        }
+        void Lines(const sf::Vertex* v, std::size_t n, const sf::Color& color, float width) override {
+            if(n < 2){
+                return;
+            }
+            Stroke(color, width);
+            for(std::size_t i = 0; i + 1 < n; i += 2){
+                Format("%.2f %.2f m %.2f %.2f l\n", v[i].position.x, v[i].position.y, v[i + 1].position.x, v[i + 1].position.y);
+            }
+            Put("S\n");
+        }
+        void Markers(const sf::Vector2f* c, std::size_t n, Marker::Shape shape, float size, const sf::Color& color) override {
+            if(n == 0){
+                return;
+            }
+            // Circles are zero-length round-capped strokes: one moveto/lineto instead of four Bezier curves.
+            const float h = shape == Marker::Point ? 0.5f : size / 2;
+            const bool stroked = shape == Marker::Cross || shape == Marker::Circle;
+            if(stroked){
+                Put("q ");
+                Stroke(color, shape == Marker::Circle ? size : size / 4);
+                Put(shape == Marker::Circle ? "1 J\n" : "0 J\n");
+            }
+            else{
+                Fill(color);
+            }
+            for(std::size_t i = 0; i < n; ++i){
+                const float x = c[i].x, y = c[i].y;
+                switch(shape){
+                    case Marker::Point:
+                    case Marker::Square: Format("%.2f %.2f %g %g re\n", x - h, y - h, 2 * h, 2 * h);
+                    break;
+                    case Marker::Circle: Format("%.2f %.2f m %.2f %.2f l\n", x, y, x, y);
+                    break;
+                    case Marker::Cross: Format("%.2f %.2f m %.2f %.2f l %.2f %.2f m %.2f %.2f l\n", x - h, y, x + h, y, x, y - h, x, y + h);
+                    break;
+                }
+            }
+            Put(stroked ? "S Q\n" : "f\n");
+        }
+        void Text(const sf::String& text, sf::Vector2f position, float size, const sf::Color& color) override {
+            Fill(color);
+            // The text matrix flips y back so glyphs are upright in the flipped page.
+            Format("BT /F1 %g Tf 1 0 0 -1 %.2f %.2f Tm (", size, position.x, position.y);
+            for(sf::Uint32 c : text){
+                if(c == '(' || c == ')' || c == '\\'){
+                    char escaped[2] = {'\\', static_cast<char>(c)};
+                    Put(escaped, 2);
+                }
+                else{
+                    char latin = c >= 32 && c < 256 ? static_cast<char>(c) : '?';
+                    Put(&latin, 1);
+                }
+            }
+            Put(") Tj ET\n");
+        }
+        void End() override {
+            std::size_t length = Offset() - start_;
+            Put("endstream\nendobj\n");
+            Object(6);
+            Format("%zu\nendobj\n", length);
+            std::size_t xref = Offset();
+            Put("xref\n0 7\n0000000000 65535 f \n");
+            for(int id = 1; id <= 6; ++id){
+                Format("%010zu 00000 n \n", objects_[id]);
+            }
+            Format("trailer\n<< /Size 7 /Root 1 0 R >>\nstartxref\n%zu\n%%EOF\n", xref);
+        }
+    };
+    inline std::unique_ptr<VectorWriter> VectorWriter::Open(const std::string& path){
+        auto ends = [&](const char* suffix){
+            std::string s(suffix);
+            return path.size() >= s.size() && path.compare(path.size() - s.size(), s.size(), s) == 0;
+        };
+        if(ends(".svg")){
+            return std::make_unique<SvgWriter>(path);
+        }
+        if(ends(".pdf")){
+            return std::make_unique<PdfWriter>(path);
+        }
+        throw std::invalid_argument("Vector export supports .svg and .pdf only: " + path);
+    }
+};